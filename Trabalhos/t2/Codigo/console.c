@@ -119,9 +119,9 @@ static void atualiza_terminais(console_t *self)
   }
 }
 
-static void insere_string_no_terminal(console_t *self, char id_terminal, char *str)
+static void insere_string_no_terminal(console_t *self, char id_terminal, char *str, char fim)
 {
-  // insere caracteres no terminal (e espaço no final)
+  // insere caracteres no terminal (e 'fim' no final)
   terminal_t *terminal = console_terminal(self, id_terminal);
   if (terminal == NULL) {
     console_printf("Terminal '%c' inválido\n", id_terminal);
@@ -132,7 +132,7 @@ static void insere_string_no_terminal(console_t *self, char id_terminal, char *s
     terminal_insere_char(terminal, *p);
     p++;
   }
-  terminal_insere_char(terminal, ' ');
+  terminal_insere_char(terminal, fim);
 }
 
 static void limpa_saida_do_terminal(console_t *self, char id_terminal)
@@ -221,12 +221,14 @@ static void interpreta_linha_entrada(console_t *self)
   // interpreta uma linha digitada pelo operador
   // Comandos aceitos:
   // Etstr entra a string 'str' no terminal 't'  ex: eb30
+  // Ltstr entra a linha 'str' no terminal 't', terminada por \n  ex: lb30 40
   // Zt    esvazia a saída do terminal 't'  ex: za
   // Dn    altera o tempo de espera do teclado  ex: d0  -> modo turbo
   // P     para a execução
   // 1     executa uma instrução
   // C     continua a execução
   // F     fim da simulação
+  // S     grava um instantâneo da memória
 
   char *linha = self->txt_entrada;
   console_printf("CMD: '%s'", linha);
@@ -234,7 +236,10 @@ static void interpreta_linha_entrada(console_t *self)
   int val;
   switch (cmd) {
     case 'E':
-      insere_string_no_terminal(self, linha[1], &linha[2]);
+      insere_string_no_terminal(self, linha[1], &linha[2], ' ');
+      break;
+    case 'L':
+      insere_string_no_terminal(self, linha[1], &linha[2], '\n');
       break;
     case 'Z':
       limpa_saida_do_terminal(self, linha[1]);
@@ -247,6 +252,7 @@ static void interpreta_linha_entrada(console_t *self)
     case '1':
     case 'C':
     case 'F':
+    case 'S':
       insere_comando_externo(self, cmd);
       break;
     default:
@@ -320,7 +326,7 @@ static void desenha_console(console_t *self)
 
 static void desenha_entrada(console_t *self)
 {
-  char txt_fixo[] = "P=para C=continua 1=passo F=fim  Ets=entra Zt=zera";
+  char txt_fixo[] = "P=para C=continua 1=passo F=fim  Ets=entra Lts=linha Zt=zera S=instantâneo";
   tela_posiciona(LINHA_ENTRADA, 0);
   tela_puts(COR_ENTRADA, ""); // gambiarra para limpar na cor certa
   tela_limpa_linha();
@@ -30,7 +30,8 @@ void console_print_status(console_t *self, char *txt);
 //   'P': para a execução,
 //   '1': executa uma instrução,
 //   'C': continua a execução,
-//   'F': finaliza a simulação.
+//   'F': finaliza a simulação,
+//   'S': grava um instantâneo da memória.
 // retorna '\0' caso não tenha comando externo digitado
 char console_comando_externo(console_t *self);
 
@@ -9,20 +9,34 @@
 #include <string.h>
 #include <stdio.h>
 #include <assert.h>
+#include <signal.h>
 
 struct controle_t {
   cpu_t *cpu;
   relogio_t *relogio;
+  disco_t *disco;
   console_t *console;
   enum { executando, passo, parado, fim } estado;
+  // função que grava um instantâneo, e seu argumento
+  func_instantaneo_t func_instantaneo;
+  void *arg_instantaneo;
 };
 
+// alterada pelo tratador de SIGUSR1, quando é pedido um instantâneo
+static volatile sig_atomic_t pediu_instantaneo = 0;
+
+static void trata_sigusr1(int sinal)
+{
+  pediu_instantaneo = 1;
+}
+
 // funções auxiliares
 static void controle_processa_comandos_da_console(controle_t *self);
 static void controle_atualiza_estado_na_console(controle_t *self);
 
 
-controle_t *controle_cria(cpu_t *cpu, console_t *console, relogio_t *relogio)
+controle_t *controle_cria(cpu_t *cpu, console_t *console, relogio_t *relogio,
+                          disco_t *disco)
 {
   controle_t *self = malloc(sizeof(*self));
   assert(self != NULL);
@@ -30,11 +44,30 @@ controle_t *controle_cria(cpu_t *cpu, console_t *console, relogio_t *relogio)
   self->cpu = cpu;
   self->console = console;
   self->relogio = relogio;
+  self->disco = disco;
   self->estado = parado;
+  self->func_instantaneo = NULL;
+  self->arg_instantaneo = NULL;
 
   return self;
 }
 
+void controle_define_instantaneo(controle_t *self, func_instantaneo_t func, void *arg)
+{
+  self->func_instantaneo = func;
+  self->arg_instantaneo = arg;
+  signal(SIGUSR1, trata_sigusr1);
+}
+
+static void controle_grava_instantaneo(controle_t *self)
+{
+  if (self->func_instantaneo == NULL) {
+    console_printf("Instantâneo não disponível");
+    return;
+  }
+  self->func_instantaneo(self->arg_instantaneo);
+}
+
 void controle_destroi(controle_t *self)
 {
   free(self);
@@ -47,6 +80,7 @@ void controle_laco(controle_t *self)
     if (self->estado == passo || self->estado == executando) {
       cpu_executa_1(self->cpu);
       relogio_tictac(self->relogio);
+      disco_tictac(self->disco);
 
       if (self->estado == passo) self->estado = parado;
 
@@ -57,6 +91,12 @@ void controle_laco(controle_t *self)
       if (tem_int != 0) {
         cpu_interrompe(self->cpu, IRQ_RELOGIO);
       }
+      // idem para o disco, que pede interrupção enquanto tem pedidos concluídos
+      //   não informados ao SO (se a CPU não aceitar agora, tenta de novo na
+      //   próxima instrução)
+      if (disco_interrupcao(self->disco)) {
+        cpu_interrompe(self->cpu, IRQ_DISCO);
+      }
     }
     console_tictac(self->console);
 
@@ -85,6 +125,13 @@ static void controle_processa_comandos_da_console(controle_t *self)
     case 'C':
       self->estado = executando;
       break;
+    case 'S':
+      controle_grava_instantaneo(self);
+      break;
+  }
+  if (pediu_instantaneo) {
+    pediu_instantaneo = 0;
+    controle_grava_instantaneo(self);
   }
 }
 
@@ -11,11 +11,21 @@ typedef struct controle_t controle_t;
 #include "cpu.h"
 #include "console.h"
 #include "relogio.h"
+#include "disco.h"
 
-controle_t *controle_cria(cpu_t *cpu, console_t *console, relogio_t *relogio);
+controle_t *controle_cria(cpu_t *cpu, console_t *console, relogio_t *relogio,
+                          disco_t *disco);
 void controle_destroi(controle_t *self);
 
 // o laço principal da simulação
 void controle_laco(controle_t *self);
 
+// tipo da função chamada quando o operador pede um instantâneo
+typedef void (*func_instantaneo_t)(void *arg);
+
+// define a função (e seu argumento) a ser chamada quando o operador pede um
+//   instantâneo da memória, com o comando 'S' na console ou enviando o sinal
+//   SIGUSR1 para o simulador; a função é chamada entre duas instruções
+void controle_define_instantaneo(controle_t *self, func_instantaneo_t func, void *arg);
+
 #endif // CONTROLE_H
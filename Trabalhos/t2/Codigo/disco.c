@@ -0,0 +1,244 @@
+// disco.c
+// dispositivo de E/S que simula um disco com acesso direto à memória
+// simulador de computador
+// so24b
+
+#include "disco.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// a mídia é dividida em trilhas de VALORES_POR_TRILHA valores; mover a
+//   cabeça leva um tempo para começar e outro para cada trilha percorrida
+#define VALORES_POR_TRILHA 10
+#define TEMPO_INICIO_BUSCA  2
+#define TEMPO_POR_TRILHA    1
+// espera média até o início do dado passar pela cabeça
+#define TEMPO_ROTACAO       4
+// tempo para transferir cada valor
+#define TEMPO_POR_VALOR     1
+
+typedef struct pedido_t pedido_t;
+struct pedido_t {
+  int comando;
+  int end_midia;
+  int end_mem;
+  int n;
+  int etiqueta;
+  pedido_t *prox;
+};
+
+struct disco_t {
+  mem_t *midia;
+  mem_t *mem;
+  // valores para o próximo pedido
+  int end_midia;
+  int end_mem;
+  int n;
+  int etiqueta;
+  // pedidos esperando atendimento, na ordem de chegada
+  pedido_t *fila;
+  // pedido sendo atendido, e quanto tempo falta para terminar
+  pedido_t *atual;
+  int t_ate_fim;
+  // posição da cabeça (endereço na mídia)
+  int cabeca;
+  // etiquetas dos pedidos concluídos que ainda não foram lidas
+  int *concluidos;
+  int n_concluidos;
+  int cap_concluidos;
+};
+
+disco_t *disco_cria(mem_t *midia, mem_t *mem)
+{
+  disco_t *self = calloc(1, sizeof(*self));
+  assert(self != NULL);
+  self->midia = midia;
+  self->mem = mem;
+  return self;
+}
+
+static void libera_pedidos(pedido_t *p)
+{
+  while (p != NULL) {
+    pedido_t *prox = p->prox;
+    free(p);
+    p = prox;
+  }
+}
+
+void disco_destroi(disco_t *self)
+{
+  libera_pedidos(self->fila);
+  libera_pedidos(self->atual);
+  free(self->concluidos);
+  free(self);
+}
+
+static void insere_concluido(disco_t *self, int etiqueta)
+{
+  if (self->n_concluidos == self->cap_concluidos) {
+    self->cap_concluidos = self->cap_concluidos * 2 + 8;
+    self->concluidos = realloc(self->concluidos,
+                               self->cap_concluidos * sizeof(int));
+    assert(self->concluidos != NULL);
+  }
+  self->concluidos[self->n_concluidos++] = etiqueta;
+}
+
+static int retira_concluido(disco_t *self)
+{
+  if (self->n_concluidos == 0) return -1;
+  int etiqueta = self->concluidos[0];
+  self->n_concluidos--;
+  memmove(self->concluidos, self->concluidos + 1,
+          self->n_concluidos * sizeof(int));
+  return etiqueta;
+}
+
+// tempo para atender o pedido, com a cabeça na posição atual
+static int duracao(disco_t *self, pedido_t *p)
+{
+  int trilhas = abs(p->end_midia / VALORES_POR_TRILHA - self->cabeca / VALORES_POR_TRILHA);
+  int busca = trilhas == 0 ? 0 : TEMPO_INICIO_BUSCA + trilhas * TEMPO_POR_TRILHA;
+  return busca + TEMPO_ROTACAO + p->n * TEMPO_POR_VALOR;
+}
+
+// faz a transferência do pedido (o DMA)
+static void transfere(disco_t *self, pedido_t *p)
+{
+  err_t err;
+  if (p->comando == DISCO_LE) {
+    err = mem_copia_bloco(self->mem, p->end_mem, self->midia, p->end_midia, p->n);
+  } else {
+    err = mem_copia_bloco(self->midia, p->end_midia, self->mem, p->end_mem, p->n);
+  }
+  // os endereços foram verificados quando o pedido foi feito
+  assert(err == ERR_OK);
+}
+
+void disco_tictac(disco_t *self)
+{
+  if (self->atual == NULL && self->fila != NULL) {
+    self->atual = self->fila;
+    self->fila = self->fila->prox;
+    self->atual->prox = NULL;
+    self->t_ate_fim = duracao(self, self->atual);
+  }
+  if (self->atual == NULL) return;
+  self->t_ate_fim--;
+  if (self->t_ate_fim <= 0) {
+    transfere(self, self->atual);
+    self->cabeca = self->atual->end_midia + self->atual->n;
+    insere_concluido(self, self->atual->etiqueta);
+    free(self->atual);
+    self->atual = NULL;
+  }
+}
+
+bool disco_interrupcao(disco_t *self)
+{
+  return self->n_concluidos > 0;
+}
+
+static int n_pendentes(disco_t *self)
+{
+  int n = self->atual != NULL ? 1 : 0;
+  for (pedido_t *p = self->fila; p != NULL; p = p->prox) n++;
+  return n;
+}
+
+static err_t enfileira(disco_t *self, int comando)
+{
+  if (self->n <= 0
+      || self->end_midia < 0 || self->end_midia > mem_tam(self->midia) - self->n
+      || self->end_mem < 0 || self->end_mem > mem_tam(self->mem) - self->n) {
+    return ERR_END_INV;
+  }
+  pedido_t *p = malloc(sizeof(*p));
+  assert(p != NULL);
+  p->comando = comando;
+  p->end_midia = self->end_midia;
+  p->end_mem = self->end_mem;
+  p->n = self->n;
+  p->etiqueta = self->etiqueta;
+  p->prox = NULL;
+  pedido_t **pp = &self->fila;
+  while (*pp != NULL) pp = &(*pp)->prox;
+  *pp = p;
+  return ERR_OK;
+}
+
+static err_t cancela(disco_t *self, int etiqueta)
+{
+  if (self->atual != NULL && self->atual->etiqueta == etiqueta) {
+    free(self->atual);
+    self->atual = NULL;
+    return ERR_OK;
+  }
+  for (pedido_t **pp = &self->fila; *pp != NULL; pp = &(*pp)->prox) {
+    if ((*pp)->etiqueta == etiqueta) {
+      pedido_t *p = *pp;
+      *pp = p->prox;
+      free(p);
+      return ERR_OK;
+    }
+  }
+  return ERR_OP_INV;
+}
+
+err_t disco_leitura(void *disp, int id, int *pvalor)
+{
+  disco_t *self = disp;
+  err_t err = ERR_OK;
+  switch (id) {
+    case 4:
+      *pvalor = n_pendentes(self);
+      break;
+    case 5:
+      *pvalor = retira_concluido(self);
+      break;
+    case 6:
+      *pvalor = disco_interrupcao(self);
+      break;
+    case 7:
+      *pvalor = self->cabeca;
+      break;
+    default:
+      err = ERR_OP_INV;
+  }
+  return err;
+}
+
+err_t disco_escrita(void *disp, int id, int valor)
+{
+  disco_t *self = disp;
+  err_t err = ERR_OK;
+  switch (id) {
+    case 0:
+      self->end_midia = valor;
+      break;
+    case 1:
+      self->end_mem = valor;
+      break;
+    case 2:
+      self->n = valor;
+      break;
+    case 3:
+      self->etiqueta = valor;
+      break;
+    case 4:
+      if (valor == DISCO_LE || valor == DISCO_GRAVA) {
+        err = enfileira(self, valor);
+      } else if (valor == DISCO_CANCELA) {
+        err = cancela(self, self->etiqueta);
+      } else {
+        err = ERR_OP_INV;
+      }
+      break;
+    default:
+      err = ERR_OP_INV;
+  }
+  return err;
+}
@@ -0,0 +1,72 @@
+// disco.h
+// dispositivo de E/S que simula um disco com acesso direto à memória
+// simulador de computador
+// so24b
+
+#ifndef DISCO_H
+#define DISCO_H
+
+// simulador do controlador de disco
+// o disco transfere dados entre a sua mídia (uma região de memória) e a
+//   memória principal, por DMA, sem passar pela CPU
+// os pedidos de transferência são colocados em uma fila e atendidos um de
+//   cada vez, na ordem de chegada; cada pedido leva um tempo (em instruções
+//   executadas) para mover a cabeça até a trilha do endereço na mídia (um
+//   tempo fixo mais um tempo por trilha percorrida), esperar a rotação e
+//   transferir os valores. Os dados são copiados quando
+//   o pedido termina, e o disco passa a pedir interrupção (IRQ_DISCO) até
+//   que todos os pedidos concluídos tenham sido lidos.
+// cada pedido é identificado por uma etiqueta escolhida por quem o fez
+
+#include "err.h"
+#include "memoria.h"
+
+#include <stdbool.h>
+
+// comandos aceitos pelo disco (escritos no dispositivo '4')
+// lê da mídia para a memória principal
+#define DISCO_LE      1
+// grava da memória principal na mídia
+#define DISCO_GRAVA   2
+// cancela o pedido com a etiqueta definida no dispositivo '3'
+#define DISCO_CANCELA 3
+
+typedef struct disco_t disco_t;
+
+// cria um disco com a mídia 'midia', que transfere dados de e para a memória 'mem'
+disco_t *disco_cria(mem_t *midia, mem_t *mem);
+
+// destrói um disco, descartando os pedidos pendentes
+// nenhuma outra operação pode ser realizada no disco após esta chamada
+void disco_destroi(disco_t *self);
+
+// registra a passagem de uma unidade de tempo
+// esta função é chamada pelo controlador após a execução de cada instrução
+void disco_tictac(disco_t *self);
+
+// retorna true se o disco está pedindo interrupção (tem pedidos concluídos
+//   cujas etiquetas ainda não foram lidas)
+bool disco_interrupcao(disco_t *self);
+
+// Funções para acessar o disco como dispositivo de E/S, com id:
+//   '0' para escrever o endereço na mídia do próximo pedido
+//   '1' para escrever o endereço na memória principal do próximo pedido
+//   '2' para escrever o número de valores a transferir no próximo pedido
+//   '3' para escrever a etiqueta do próximo pedido (ou do pedido a cancelar)
+//   '4' para escrever um comando (DISCO_LE, DISCO_GRAVA ou DISCO_CANCELA), ou
+//       ler o número de pedidos ainda não concluídos
+//       DISCO_LE e DISCO_GRAVA colocam na fila um pedido com os valores dos
+//       dispositivos 0 a 3 (erro ERR_END_INV se a faixa de endereços for
+//       inválida); DISCO_CANCELA retira o pedido da fila sem fazer a
+//       transferência (erro ERR_OP_INV se o pedido não estiver pendente, por
+//       já ter sido concluído)
+//   '5' para ler a etiqueta de um pedido concluído, ou -1 se não houver; cada
+//       leitura consome a etiqueta lida
+//   '6' para ler se o disco está pedindo interrupção
+//   '7' para ler a posição da cabeça (endereço na mídia logo após o último
+//       valor transferido)
+// Devem seguir o protocolo f_leitura_t e f_escrita_t declarados em es.h
+err_t disco_leitura(void *disp, int id, int *pvalor);
+err_t disco_escrita(void *disp, int id, int valor);
+
+#endif // DISCO_H
@@ -27,6 +27,14 @@ typedef enum {
   D_RELOGIO_REAL          = 17,
   D_RELOGIO_TIMER         = 18,
   D_RELOGIO_INTERRUPCAO   = 19,
+  D_DISCO_END_MIDIA       = 20,
+  D_DISCO_END_MEM         = 21,
+  D_DISCO_TAMANHO         = 22,
+  D_DISCO_ETIQUETA        = 23,
+  D_DISCO_COMANDO         = 24,
+  D_DISCO_CONCLUIDO       = 25,
+  D_DISCO_INTERRUPCAO     = 26,
+  D_DISCO_CABECA          = 27,
   N_DISPOSITIVOS
 } dispositivo_id_t;
 
@@ -100,6 +100,20 @@ void fifo_pega(fifo_t *self, pagina_t *pagina)
     fifo_retira_pagina(self);
 }
 
+bool fifo_pega_processo(fifo_t *self, processo_t *processo, pagina_t *pagina)
+{
+    for (pagina_t *atual = self->head; atual != NULL; atual = atual->next)
+    {
+        if (atual->processo == processo)
+        {
+            *pagina = *atual;
+            pagina->next = NULL;
+            return fifo_retira_quadro(self, pagina->quadro_num);
+        }
+    }
+    return false;
+}
+
 int fifo_prox_pag_num(fifo_t *self)
 {
     return self->head->num;
@@ -159,7 +173,10 @@ void fifo_liberaPags_processo(fifo_t *self, int processo_pid)
             else
             {
                 self->head = atual->next;
-                self->last = atual->next;
+            }
+            if (atual == self->last)
+            {
+                self->last = anterior;
             }
             pagina_t *temp = atual;
             atual = atual->next;
@@ -171,4 +188,40 @@ void fifo_liberaPags_processo(fifo_t *self, int processo_pid)
             atual = atual->next;
         }
     }
-}
\ No newline at end of file
+}
+
+bool fifo_retira_quadro(fifo_t *self, int quadro)
+{
+    pagina_t *anterior = NULL;
+    for (pagina_t *atual = self->head; atual != NULL; atual = atual->next)
+    {
+        if (atual->quadro_num == quadro)
+        {
+            if (anterior != NULL)
+                anterior->next = atual->next;
+            else
+                self->head = atual->next;
+            if (atual == self->last)
+                self->last = anterior;
+            free(atual);
+            self->num_pags--;
+            return true;
+        }
+        anterior = atual;
+    }
+    return false;
+}
+
+bool fifo_troca_dono(fifo_t *self, int quadro, tabpag_t *tab, processo_t *processo)
+{
+    for (pagina_t *atual = self->head; atual != NULL; atual = atual->next)
+    {
+        if (atual->quadro_num == quadro)
+        {
+            atual->tab_pag = tab;
+            atual->processo = processo;
+            return true;
+        }
+    }
+    return false;
+}
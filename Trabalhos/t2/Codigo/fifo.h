@@ -69,4 +69,18 @@ void fifo_liberaPags_processo(fifo_t *self, int processo);
 // pega a primeira página da fila
 void fifo_pega(fifo_t *self, pagina_t *pagina);
 
+// pega a primeira página do processo na fila
+// retorna false se não há página do processo na fila
+bool fifo_pega_processo(fifo_t *self, processo_t *processo, pagina_t *pagina);
+
+// troca o processo (e a tabela de páginas) da página que está no quadro
+//   'quadro', sem mudar a posição na fila
+// retorna false se não há página do quadro na fila
+bool fifo_troca_dono(fifo_t *self, int quadro, tabpag_t *tab, processo_t *processo);
+
+// retira da fila a página que está no quadro 'quadro' (que foi liberado
+//   sem ser escolhido como vítima)
+// retorna false se não há página do quadro na fila
+bool fifo_retira_quadro(fifo_t *self, int quadro);
+
 #endif // FIFO_H
\ No newline at end of file
@@ -0,0 +1,238 @@
+// fila_disco.c
+// fila de pedidos ao disco, com escalonamento
+// simulador de computador
+// so24b
+
+#include "fila_disco.h"
+#include "disco.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <assert.h>
+
+// prazos da política DEADLINE, em instruções desde a chegada do pedido
+#define PRAZO_LEITURA 250
+#define PRAZO_GRAVACAO 1000
+
+struct fila_disco_t
+{
+  esc_disco_t politica;
+  // pedidos, na ordem de chegada
+  pedido_disco_t *pedidos;
+  int n_pedidos;
+  int capacidade;
+  // sentido em que a cabeça está andando no SCAN (1 ou -1)
+  int sentido;
+};
+
+static char *nomes[N_ESC_DISCO] = {
+    [ESC_DISCO_FCFS] = "fcfs",
+    [ESC_DISCO_SSTF] = "sstf",
+    [ESC_DISCO_SCAN] = "scan",
+    [ESC_DISCO_CLOOK] = "clook",
+    [ESC_DISCO_DEADLINE] = "deadline",
+};
+
+fila_disco_t *fila_disco_cria(esc_disco_t politica)
+{
+  fila_disco_t *self = malloc(sizeof(*self));
+  assert(self != NULL);
+  self->politica = politica;
+  self->pedidos = NULL;
+  self->n_pedidos = 0;
+  self->capacidade = 0;
+  self->sentido = 1;
+  return self;
+}
+
+void fila_disco_destroi(fila_disco_t *self)
+{
+  if (self != NULL)
+  {
+    free(self->pedidos);
+    free(self);
+  }
+}
+
+void fila_disco_define_politica(fila_disco_t *self, esc_disco_t politica)
+{
+  self->politica = politica;
+}
+
+char *fila_disco_nome(esc_disco_t politica)
+{
+  if (politica < 0 || politica >= N_ESC_DISCO)
+    return NULL;
+  return nomes[politica];
+}
+
+int fila_disco_politica(char *nome)
+{
+  for (int i = 0; i < N_ESC_DISCO; i++)
+  {
+    if (strcasecmp(nomes[i], nome) == 0)
+      return i;
+  }
+  return -1;
+}
+
+void fila_disco_insere(fila_disco_t *self, int comando, int end_sec, int tamanho,
+                       int etiqueta, int agora)
+{
+  if (self->n_pedidos == self->capacidade)
+  {
+    self->capacidade = self->capacidade * 2 + 8;
+    self->pedidos = realloc(self->pedidos, self->capacidade * sizeof(pedido_disco_t));
+    assert(self->pedidos != NULL);
+  }
+  pedido_disco_t *p = &self->pedidos[self->n_pedidos++];
+  p->comando = comando;
+  p->end_sec = end_sec;
+  p->tamanho = tamanho;
+  p->etiqueta = etiqueta;
+  p->chegada = agora;
+}
+
+int fila_disco_tamanho(fila_disco_t *self)
+{
+  return self->n_pedidos;
+}
+
+// o pedido 'i' pode ser atendido: não há pedido mais antigo para endereços
+//   que se sobrepõem aos seus
+static bool fila_disco__pode(fila_disco_t *self, int i)
+{
+  pedido_disco_t *p = &self->pedidos[i];
+  for (int j = 0; j < i; j++)
+  {
+    pedido_disco_t *a = &self->pedidos[j];
+    if (a->end_sec < p->end_sec + p->tamanho && p->end_sec < a->end_sec + a->tamanho)
+      return false;
+  }
+  return true;
+}
+
+static int distancia(int a, int b)
+{
+  return a > b ? a - b : b - a;
+}
+
+static int fila_disco__sstf(fila_disco_t *self, int cabeca)
+{
+  int escolhido = -1;
+  for (int i = 0; i < self->n_pedidos; i++)
+  {
+    if (!fila_disco__pode(self, i))
+      continue;
+    if (escolhido == -1 ||
+        distancia(self->pedidos[i].end_sec, cabeca) < distancia(self->pedidos[escolhido].end_sec, cabeca))
+      escolhido = i;
+  }
+  return escolhido;
+}
+
+// o pedido mais próximo da cabeça no sentido 'sentido', ou -1
+static int fila_disco__a_frente(fila_disco_t *self, int cabeca, int sentido)
+{
+  int escolhido = -1;
+  for (int i = 0; i < self->n_pedidos; i++)
+  {
+    int end = self->pedidos[i].end_sec;
+    if ((end - cabeca) * sentido < 0 || !fila_disco__pode(self, i))
+      continue;
+    if (escolhido == -1 || distancia(end, cabeca) < distancia(self->pedidos[escolhido].end_sec, cabeca))
+      escolhido = i;
+  }
+  return escolhido;
+}
+
+static int fila_disco__scan(fila_disco_t *self, int cabeca)
+{
+  int escolhido = fila_disco__a_frente(self, cabeca, self->sentido);
+  if (escolhido == -1)
+  {
+    self->sentido = -self->sentido;
+    escolhido = fila_disco__a_frente(self, cabeca, self->sentido);
+  }
+  return escolhido;
+}
+
+static int fila_disco__clook(fila_disco_t *self, int cabeca)
+{
+  int escolhido = fila_disco__a_frente(self, cabeca, 1);
+  if (escolhido == -1)
+  {
+    // volta para o início: o de menor endereço
+    escolhido = fila_disco__a_frente(self, 0, 1);
+  }
+  return escolhido;
+}
+
+static int fila_disco__deadline(fila_disco_t *self, int cabeca, int agora)
+{
+  // o pedido vencido com o prazo mais antigo
+  int escolhido = -1;
+  int prazo_escolhido = 0;
+  for (int i = 0; i < self->n_pedidos; i++)
+  {
+    pedido_disco_t *p = &self->pedidos[i];
+    int prazo = p->chegada + (p->comando == DISCO_LE ? PRAZO_LEITURA : PRAZO_GRAVACAO);
+    if (prazo > agora || !fila_disco__pode(self, i))
+      continue;
+    if (escolhido == -1 || prazo < prazo_escolhido)
+    {
+      escolhido = i;
+      prazo_escolhido = prazo;
+    }
+  }
+  if (escolhido != -1)
+    return escolhido;
+  return fila_disco__clook(self, cabeca);
+}
+
+bool fila_disco_retira(fila_disco_t *self, int cabeca, int agora, pedido_disco_t *pedido)
+{
+  if (self->n_pedidos == 0)
+    return false;
+  int escolhido;
+  switch (self->politica)
+  {
+  case ESC_DISCO_SSTF:
+    escolhido = fila_disco__sstf(self, cabeca);
+    break;
+  case ESC_DISCO_SCAN:
+    escolhido = fila_disco__scan(self, cabeca);
+    break;
+  case ESC_DISCO_CLOOK:
+    escolhido = fila_disco__clook(self, cabeca);
+    break;
+  case ESC_DISCO_DEADLINE:
+    escolhido = fila_disco__deadline(self, cabeca, agora);
+    break;
+  default:
+    escolhido = 0;
+  }
+  // o primeiro pedido sempre pode ser atendido, então sempre há escolha
+  assert(escolhido != -1);
+  *pedido = self->pedidos[escolhido];
+  self->n_pedidos--;
+  memmove(&self->pedidos[escolhido], &self->pedidos[escolhido + 1],
+          (self->n_pedidos - escolhido) * sizeof(pedido_disco_t));
+  return true;
+}
+
+bool fila_disco_cancela(fila_disco_t *self, int etiqueta)
+{
+  for (int i = 0; i < self->n_pedidos; i++)
+  {
+    if (self->pedidos[i].etiqueta == etiqueta)
+    {
+      self->n_pedidos--;
+      memmove(&self->pedidos[i], &self->pedidos[i + 1],
+              (self->n_pedidos - i) * sizeof(pedido_disco_t));
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,86 @@
+// fila_disco.h
+// fila de pedidos ao disco, com escalonamento
+// simulador de computador
+// so24b
+
+#ifndef FILA_DISCO_H
+#define FILA_DISCO_H
+
+// mantém os pedidos de transferência que o SO ainda não entregou ao disco, e
+//   escolhe qual será o próximo, conforme a política:
+//   - FCFS: na ordem de chegada
+//   - SSTF: o mais próximo da cabeça do disco
+//   - SCAN (elevador): o mais próximo no sentido em que a cabeça está
+//     andando; o sentido inverte quando não há mais pedidos à frente
+//   - C-LOOK: o mais próximo à frente da cabeça, sempre no sentido crescente;
+//     quando não há mais pedidos à frente, volta para o de menor endereço
+//   - DEADLINE: como o C-LOOK, mas cada pedido tem um prazo (menor para
+//     leituras, que têm processos esperando); se o pedido mais antigo passou
+//     do prazo, ele é atendido primeiro
+// em qualquer política, pedidos para endereços que se sobrepõem são atendidos
+//   na ordem de chegada (uma leitura não pode passar na frente da gravação
+//   da mesma página)
+
+#include <stdbool.h>
+
+// políticas de escalonamento
+typedef enum
+{
+  ESC_DISCO_FCFS,
+  ESC_DISCO_SSTF,
+  ESC_DISCO_SCAN,
+  ESC_DISCO_CLOOK,
+  ESC_DISCO_DEADLINE,
+  N_ESC_DISCO
+} esc_disco_t;
+
+// um pedido ao disco
+typedef struct
+{
+  // DISCO_LE ou DISCO_GRAVA (ver disco.h)
+  int comando;
+  // endereço na memória secundária, e número de valores a transferir
+  int end_sec;
+  int tamanho;
+  // etiqueta do pedido
+  int etiqueta;
+  // instante em que o pedido foi feito
+  int chegada;
+} pedido_disco_t;
+
+// tipo opaco que representa a fila
+typedef struct fila_disco_t fila_disco_t;
+
+// cria uma fila vazia, com a política 'politica'
+// mata o programa em caso de erro (malloc)
+fila_disco_t *fila_disco_cria(esc_disco_t politica);
+
+// destrói a fila
+void fila_disco_destroi(fila_disco_t *self);
+
+// muda a política de escalonamento
+void fila_disco_define_politica(fila_disco_t *self, esc_disco_t politica);
+
+// retorna o nome da política (NULL se não existe)
+char *fila_disco_nome(esc_disco_t politica);
+
+// retorna a política com o nome 'nome' (-1 se não existe)
+int fila_disco_politica(char *nome);
+
+// insere um pedido na fila
+void fila_disco_insere(fila_disco_t *self, int comando, int end_sec, int tamanho,
+                       int etiqueta, int agora);
+
+// retira da fila o próximo pedido a ser atendido, com a cabeça do disco no
+//   endereço 'cabeca', colocando-o em 'pedido'
+// retorna false se a fila está vazia
+bool fila_disco_retira(fila_disco_t *self, int cabeca, int agora, pedido_disco_t *pedido);
+
+// retira da fila o pedido com a etiqueta 'etiqueta'
+// retorna false se não há pedido com essa etiqueta na fila
+bool fila_disco_cancela(fila_disco_t *self, int etiqueta);
+
+// número de pedidos na fila
+int fila_disco_tamanho(fila_disco_t *self);
+
+#endif // FILA_DISCO_H
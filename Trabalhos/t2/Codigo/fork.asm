@@ -0,0 +1,217 @@
+; fork.asm
+; programa de exemplo para SO
+; testa a chamada SO_FORK: as páginas são compartilhadas com o filho, e
+;   copiadas quando um dos processos escreve nelas
+
+; preenche um vetor com 0..N-1 e cria um filho; o pai soma 1000 a cada
+;   elemento; os dois criam mais um filho, e cada pai soma 10
+; cada um dos 4 processos imprime a soma do vetor que vê:
+;   221900 (o original), 219900, 21900 e 19900
+N        define 200  ; tamanho do vetor (ocupa várias páginas)
+
+         desv main
+prog     string 'fork: soma '
+
+; chamadas de sistema (ver so.h)
+SO_MATA_PROC   define 8
+SO_FORK        define 10
+SO_ESCR_STR    define 12
+
+main
+         chama preenche
+         ; no filho, SO_FORK retorna 0
+         cargi SO_FORK
+         chamas
+         desvz main_1
+         cargm mil
+         chama soma_vet
+main_1   cargi SO_FORK
+         chamas
+         desvz main_2
+         cargm dez
+         chama soma_vet
+main_2   cargi prog
+         chama impstr
+         chama soma_tudo
+         chama impnum
+         chama morre
+         para
+
+morre    espaco 1
+         cargi 0
+         trax
+         cargi SO_MATA_PROC
+         chamas
+         ret morre
+
+; coloca 0..N-1 no vetor
+preenche espaco 1
+         cargi 0
+         trax
+pr_1     cpxa
+         armx vet
+         incx
+         cpxa
+         sub ene
+         desvnz pr_1
+         ret preenche
+
+; soma o valor de A a cada elemento do vetor
+soma_vet espaco 1
+         armm sv_val
+         cargi 0
+         trax
+sv_1     cargx vet
+         soma sv_val
+         armx vet
+         incx
+         cpxa
+         sub ene
+         desvnz sv_1
+         ret soma_vet
+sv_val   espaco 1
+
+; retorna em A a soma dos elementos do vetor
+soma_tudo espaco 1
+         cargi 0
+         armm st_soma
+         trax
+st_1     cargx vet
+         soma st_soma
+         armm st_soma
+         incx
+         cpxa
+         sub ene
+         desvnz st_1
+         cargm st_soma
+         ret soma_tudo
+st_soma  espaco 1
+ene      valor N
+mil      valor 1000
+
+; imprime a string que inicia em A (destroi X)
+; conta os caracteres e chama o SO uma vez só, para a string toda
+impstr   espaco 1
+         armm is_end
+         trax
+impstr1
+         cargx 0
+         desvz impstrf
+         incx
+         desv impstr1
+impstrf  cpxa
+         sub is_end
+         armm is_tam
+         cargi is_end
+         trax
+         cargi SO_ESCR_STR
+         chamas
+         ret impstr
+; argumentos de SO_ESCR_STR: endereço e número de caracteres
+is_end   espaco 1
+is_tam   espaco 1
+
+; escreve o valor de A no terminal, em decimal
+; os caracteres são juntados em ei_buf, e escritos com uma chamada ao SO
+; não altera o valor de X
+impnum  espaco 1
+        ; ei_num = A
+        armm ei_num
+        ; ei_n = 0
+        cargi 0
+        armm ei_n
+        cargm ei_num
+        ; if ei_num > 0 goto ei_pos
+        desvp ei_pos
+        ; if ei_num < 0 goto ei_neg
+        desvn ei_neg
+        ; print '0'; goto ei_f
+        cargi '0'
+        chama ei_poe
+        desv ei_f
+ei_neg
+        ; ei_num = -ei_num
+        neg
+        armm ei_num
+        ; print '-'
+        cargi '-'
+        chama ei_poe
+ei_pos
+        ; faz ei_mul ser a maior potência de 10 <= ei_num
+        ; ei_mul = 1
+        cargi 1
+        armm ei_mul
+ei_1
+        ; if ei_mul == ei_num goto ei_3
+        cargm ei_mul
+        sub ei_num
+        desvz ei_3
+        ; if ei_mul > ei_num goto ei_2
+        desvp ei_2
+        ; ei_mul *= 10
+        cargm ei_mul
+        mult dez
+        armm ei_mul
+        ; goto ei_1
+        desv ei_1
+ei_2
+        ; ei_mul /= 10
+        cargm ei_mul
+        div dez
+        armm ei_mul
+ei_3
+        ; print (ei_num/ei_mul) % 10 + '0'
+        cargm ei_num
+        div ei_mul
+        resto dez
+        soma a_zero
+        chama ei_poe
+        ; ei_mul /= 10
+        cargm ei_mul
+        div dez
+        armm ei_mul
+        ; if ei_mul > 0 goto ei_3
+        desvp ei_3
+ei_f
+        ; print ' '
+        cargi ' '
+        chama ei_poe
+        ; escreve ei_buf, salvando X
+        trax
+        armm ei_X
+        cargi ei_arg
+        trax
+        cargi SO_ESCR_STR
+        chamas
+        cargm ei_X
+        trax
+        ; return
+        ret impnum
+
+; põe o caractere em A no fim de ei_buf (não altera o valor de X)
+ei_poe  espaco 1
+        armm ei_car
+        trax
+        armm ei_X
+        cargm ei_n
+        trax
+        cargm ei_car
+        armx ei_buf
+        incx
+        cpxa
+        armm ei_n
+        cargm ei_X
+        trax
+        ret ei_poe
+ei_num  espaco 1
+ei_mul  espaco 1
+a_zero  valor '0'
+dez     valor 10
+ei_car  espaco 1
+ei_X    espaco 1
+ei_buf  espaco 12
+; argumentos de SO_ESCR_STR: endereço e número de caracteres de ei_buf
+ei_arg  valor ei_buf
+ei_n    espaco 1
+
+vet      espaco N
@@ -0,0 +1,43 @@
+// geometria.c
+// configuração das memórias do computador simulado
+// simulador de computador
+// so24b
+
+#include "geometria.h"
+
+#include <stdlib.h>
+
+void geometria_padrao(geometria_t *self)
+{
+  self->tam_pagina = GEOM_TAM_PAGINA;
+  self->tam_mem = GEOM_TAM_MEM;
+  self->n_quadros = 0;
+  self->tam_disco = GEOM_TAM_DISCO;
+  self->paginas_grandes = GEOM_PAGINAS_GRANDES;
+}
+
+int geometria_primeiro_quadro(geometria_t *self)
+{
+  return (GEOM_END_RESERVADO - 1) / self->tam_pagina + 1;
+}
+
+char *geometria_confere(geometria_t *self)
+{
+  if (self->tam_pagina < 1)
+    return "o tamanho da página deve ser positivo";
+  if (self->tam_mem < GEOM_END_RESERVADO)
+    return "a memória principal não tem espaço para o SO";
+  if (self->n_quadros < 0)
+    return "o número de quadros não pode ser negativo";
+  if (self->n_quadros == 0)
+    self->n_quadros = self->tam_mem / self->tam_pagina;
+  if (self->n_quadros > self->tam_mem / self->tam_pagina)
+    return "os quadros não cabem na memória principal";
+  if (self->n_quadros <= geometria_primeiro_quadro(self))
+    return "não sobram quadros para os processos";
+  if (self->tam_disco < self->tam_pagina)
+    return "a memória secundária não tem espaço para uma página";
+  if (self->paginas_grandes < 0 || self->paginas_grandes == 1)
+    return "uma página grande deve ter pelo menos duas páginas";
+  return NULL;
+}
@@ -0,0 +1,47 @@
+// geometria.h
+// configuração das memórias do computador simulado
+// simulador de computador
+// so24b
+
+#ifndef GEOMETRIA_H
+#define GEOMETRIA_H
+
+// os tamanhos das memórias e da página são escolhidos na execução (opções
+//   do main), para que o mesmo executável possa comparar configurações
+//   diferentes; a memória principal é criada com 'tam_mem' palavras, a MMU
+//   usa páginas de 'tam_pagina' palavras, e o SO usa os primeiros
+//   'n_quadros' quadros da memória principal; páginas consecutivas podem
+//   ser juntadas em páginas grandes de 'paginas_grandes' páginas
+
+// valores usados se não forem escolhidos outros
+#define GEOM_TAM_PAGINA 10     // tamanho de uma página, em palavras
+#define GEOM_TAM_MEM 1000      // tamanho da memória principal
+#define GEOM_TAM_DISCO 100000  // tamanho da memória secundária
+#define GEOM_PAGINAS_GRANDES 4 // páginas em uma página grande (0 para não usar)
+
+// os endereços abaixo deste são do SO (vetor de interrupção e tratador),
+//   e não podem estar nos quadros usados pelos processos
+#define GEOM_END_RESERVADO 100
+
+typedef struct
+{
+  int tam_pagina;
+  int tam_mem;
+  // número de quadros da memória principal usados (0 para todos os que
+  //   cabem nela)
+  int n_quadros;
+  int tam_disco;
+  int paginas_grandes;
+} geometria_t;
+
+// inicializa a geometria com os valores padrão
+void geometria_padrao(geometria_t *self);
+
+// confere a geometria, e completa o número de quadros se for 0
+// retorna NULL se ela é válida, ou uma mensagem explicando o problema
+char *geometria_confere(geometria_t *self);
+
+// primeiro quadro que não contém endereços reservados para o SO
+int geometria_primeiro_quadro(geometria_t *self);
+
+#endif // GEOMETRIA_H
@@ -0,0 +1,80 @@
+// histograma.c
+// histograma de valores, para cálculo de percentis
+// simulador de computador
+// so24b
+
+#include "histograma.h"
+
+void histograma_zera(histograma_t *self)
+{
+  self->n = 0;
+  self->total = 0;
+  self->max = 0;
+  for (int i = 0; i < HIST_N_FAIXAS; i++)
+  {
+    self->faixas[i] = 0;
+  }
+}
+
+// faixa onde fica o valor
+static int histograma__faixa(int valor)
+{
+  if (valor < 2 * HIST_SUBFAIXAS)
+    return valor;
+  // expoente da maior potência de 2 que não passa do valor
+  int expoente = 0;
+  while ((valor >> expoente) > 1)
+    expoente++;
+  int desloc = expoente - HIST_BITS_SUB;
+  int sub = (valor >> desloc) & (HIST_SUBFAIXAS - 1);
+  return 2 * HIST_SUBFAIXAS + (desloc - 1) * HIST_SUBFAIXAS + sub;
+}
+
+// maior valor que fica na faixa
+static long long histograma__limite(int faixa)
+{
+  if (faixa < 2 * HIST_SUBFAIXAS)
+    return faixa;
+  int k = faixa - 2 * HIST_SUBFAIXAS;
+  int desloc = k / HIST_SUBFAIXAS + 1;
+  int sub = k % HIST_SUBFAIXAS;
+  long long inicio = (long long)(HIST_SUBFAIXAS + sub) << desloc;
+  return inicio + (1LL << desloc) - 1;
+}
+
+void histograma_registra(histograma_t *self, int valor)
+{
+  if (valor < 0)
+    valor = 0;
+  self->faixas[histograma__faixa(valor)]++;
+  self->n++;
+  self->total += valor;
+  if (valor > self->max)
+    self->max = valor;
+}
+
+int histograma_percentil(histograma_t *self, int percentil)
+{
+  if (self->n == 0)
+    return 0;
+  // posição do valor procurado na ordem crescente (a partir de 1)
+  long long posicao = ((long long)self->n * percentil + 99) / 100;
+  if (posicao < 1)
+    posicao = 1;
+  long long acumulado = 0;
+  for (int i = 0; i < HIST_N_FAIXAS; i++)
+  {
+    acumulado += self->faixas[i];
+    if (acumulado >= posicao)
+    {
+      long long limite = histograma__limite(i);
+      return limite < self->max ? limite : self->max;
+    }
+  }
+  return self->max;
+}
+
+double histograma_media(histograma_t *self)
+{
+  return self->n == 0 ? 0.0 : (double)self->total / self->n;
+}
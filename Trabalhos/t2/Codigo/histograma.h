@@ -0,0 +1,45 @@
+// histograma.h
+// histograma de valores, para cálculo de percentis
+// simulador de computador
+// so24b
+
+#ifndef HISTOGRAMA_H
+#define HISTOGRAMA_H
+
+// conta valores inteiros não negativos em faixas de largura crescente: os
+//   valores menores que 2 * HIST_SUBFAIXAS têm uma faixa cada um, e cada
+//   potência de 2 acima disso é dividida em HIST_SUBFAIXAS faixas iguais;
+//   o erro de um percentil é no máximo 1/HIST_SUBFAIXAS do valor, e o
+//   histograma tem tamanho fixo, para ficar dentro das métricas
+// os valores negativos são contados como 0
+
+#define HIST_BITS_SUB 3
+#define HIST_SUBFAIXAS (1 << HIST_BITS_SUB)
+// faixas exatas, mais as subfaixas das potências de 2 de 2 * HIST_SUBFAIXAS
+//   até 2^30
+#define HIST_N_FAIXAS (2 * HIST_SUBFAIXAS + (31 - HIST_BITS_SUB - 1) * HIST_SUBFAIXAS)
+
+typedef struct
+{
+  // número de valores, sua soma e o maior deles
+  int n;
+  long long total;
+  int max;
+  int faixas[HIST_N_FAIXAS];
+} histograma_t;
+
+// esvazia o histograma
+void histograma_zera(histograma_t *self);
+
+// conta o valor 'valor'
+void histograma_registra(histograma_t *self, int valor);
+
+// retorna o valor abaixo do qual (ou igual) estão 'percentil' por cento dos
+//   valores contados (o maior valor da faixa onde ele está, limitado ao
+//   maior valor contado), ou 0 se o histograma está vazio
+int histograma_percentil(histograma_t *self, int percentil);
+
+// retorna a média dos valores contados, ou 0 se o histograma está vazio
+double histograma_media(histograma_t *self);
+
+#endif // HISTOGRAMA_H
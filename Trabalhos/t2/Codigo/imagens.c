@@ -0,0 +1,153 @@
+// imagens.c
+// cache das imagens dos programas executados pelos processos
+// simulador de computador
+// so24b
+
+#include "imagens.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <sys/stat.h>
+
+struct imagem_t
+{
+  char *nome;
+  // hora da última alteração do arquivo (com nanossegundos), tamanho e
+  //   i-node quando foi lido
+  struct timespec alteracao;
+  off_t tamanho;
+  ino_t inode;
+  programa_t *programa;
+  // número de usuários da imagem
+  int n_usos;
+  // o arquivo foi alterado depois de lido; a imagem não é mais encontrada
+  //   pelo nome, e é destruída quando deixar de ser usada
+  bool obsoleta;
+  imagem_t *prox;
+};
+
+struct cache_imagens_t
+{
+  imagem_t *imagens;
+  int acertos;
+};
+
+cache_imagens_t *cache_imagens_cria(void)
+{
+  cache_imagens_t *self = malloc(sizeof(*self));
+  assert(self != NULL);
+  self->imagens = NULL;
+  self->acertos = 0;
+  return self;
+}
+
+static void imagem_destroi(imagem_t *imagem)
+{
+  prog_destroi(imagem->programa);
+  free(imagem->nome);
+  free(imagem);
+}
+
+void cache_imagens_destroi(cache_imagens_t *self)
+{
+  if (self == NULL)
+    return;
+  while (self->imagens != NULL)
+  {
+    imagem_t *prox = self->imagens->prox;
+    imagem_destroi(self->imagens);
+    self->imagens = prox;
+  }
+  free(self);
+}
+
+// retira a imagem da lista e a destrói
+static void cache_imagens__remove(cache_imagens_t *self, imagem_t *imagem)
+{
+  for (imagem_t **pi = &self->imagens; *pi != NULL; pi = &(*pi)->prox)
+  {
+    if (*pi == imagem)
+    {
+      *pi = imagem->prox;
+      imagem_destroi(imagem);
+      return;
+    }
+  }
+}
+
+// retorna true se o arquivo descrito por 'st' é o mesmo que foi lido para a
+//   imagem; um arquivo refeito no mesmo segundo em que foi lido muda pelo
+//   menos nos nanossegundos da hora de alteração (ou no tamanho ou i-node,
+//   se o sistema de arquivos não guarda nanossegundos)
+static bool imagem__mesmo_arquivo(imagem_t *imagem, struct stat *st)
+{
+  return imagem->alteracao.tv_sec == st->st_mtim.tv_sec &&
+         imagem->alteracao.tv_nsec == st->st_mtim.tv_nsec &&
+         imagem->tamanho == st->st_size && imagem->inode == st->st_ino;
+}
+
+imagem_t *cache_imagens_obtem(cache_imagens_t *self, char *nome)
+{
+  struct stat st;
+  if (stat(nome, &st) != 0)
+    return NULL;
+  for (imagem_t *imagem = self->imagens; imagem != NULL; imagem = imagem->prox)
+  {
+    if (imagem->obsoleta || strcmp(imagem->nome, nome) != 0)
+      continue;
+    if (imagem__mesmo_arquivo(imagem, &st))
+    {
+      imagem->n_usos++;
+      self->acertos++;
+      return imagem;
+    }
+    // o arquivo foi alterado
+    if (imagem->n_usos == 0)
+      cache_imagens__remove(self, imagem);
+    else
+      imagem->obsoleta = true;
+    break;
+  }
+
+  programa_t *programa = prog_cria(nome);
+  if (programa == NULL)
+    return NULL;
+  imagem_t *imagem = malloc(sizeof(*imagem));
+  assert(imagem != NULL);
+  imagem->nome = strdup(nome);
+  assert(imagem->nome != NULL);
+  imagem->alteracao = st.st_mtim;
+  imagem->tamanho = st.st_size;
+  imagem->inode = st.st_ino;
+  imagem->programa = programa;
+  imagem->n_usos = 1;
+  imagem->obsoleta = false;
+  imagem->prox = self->imagens;
+  self->imagens = imagem;
+  return imagem;
+}
+
+void cache_imagens_usa(cache_imagens_t *self, imagem_t *imagem)
+{
+  imagem->n_usos++;
+}
+
+void cache_imagens_devolve(cache_imagens_t *self, imagem_t *imagem)
+{
+  imagem->n_usos--;
+  // as imagens atuais continuam na cache para os próximos processos
+  if (imagem->n_usos == 0 && imagem->obsoleta)
+    cache_imagens__remove(self, imagem);
+}
+
+int cache_imagens_acertos(cache_imagens_t *self)
+{
+  return self->acertos;
+}
+
+programa_t *imagem_programa(imagem_t *imagem)
+{
+  return imagem->programa;
+}
@@ -0,0 +1,51 @@
+// imagens.h
+// cache das imagens dos programas executados pelos processos
+// simulador de computador
+// so24b
+
+#ifndef IMAGENS_H
+#define IMAGENS_H
+
+// mantém os programas lidos dos arquivos '.maq', para que os processos que
+//   executam o mesmo programa usem a mesma imagem (e possam compartilhar as
+//   páginas que não alteram)
+// uma imagem é identificada pelo nome do arquivo e pela hora da última
+//   alteração dele (com nanossegundos), seu tamanho e i-node; se o arquivo
+//   mudou desde que foi lido, é lida uma imagem nova, e a antiga continua
+//   existindo enquanto algum processo usá-la
+
+#include "programa.h"
+
+// tipo opaco que representa a imagem de um programa
+typedef struct imagem_t imagem_t;
+
+// tipo opaco que representa a cache
+typedef struct cache_imagens_t cache_imagens_t;
+
+// cria uma cache vazia
+// mata o programa em caso de erro (malloc)
+cache_imagens_t *cache_imagens_cria(void);
+
+// destrói a cache e todas as imagens
+void cache_imagens_destroi(cache_imagens_t *self);
+
+// retorna a imagem do programa no arquivo 'nome', lendo o arquivo se ele
+//   ainda não foi lido ou se foi alterado; a imagem fica em uso até ser
+//   devolvida com cache_imagens_devolve
+// retorna NULL se não for possível ler o programa
+imagem_t *cache_imagens_obtem(cache_imagens_t *self, char *nome);
+
+// registra mais um usuário de uma imagem que já está em uso (um processo
+//   criado por SO_FORK, que executa o mesmo programa que o pai)
+void cache_imagens_usa(cache_imagens_t *self, imagem_t *imagem);
+
+// registra que um usuário da imagem não vai mais usá-la
+void cache_imagens_devolve(cache_imagens_t *self, imagem_t *imagem);
+
+// número de vezes que uma imagem foi obtida sem precisar ler o arquivo
+int cache_imagens_acertos(cache_imagens_t *self);
+
+// retorna o programa da imagem
+programa_t *imagem_programa(imagem_t *imagem);
+
+#endif // IMAGENS_H
@@ -0,0 +1,136 @@
+// inspeciona_disco.c
+// mostra o conteúdo de uma imagem da memória secundária
+// simulador de computador
+// so24b
+
+// examina o arquivo gravado pelo simulador com a opção -d (main -d imagem),
+//   sem precisar executar a simulação
+// o arquivo contém os valores da memória secundária, em sequência; é
+//   mostrado em blocos do tamanho de uma página, que é a unidade de
+//   alocação do espaço de troca do SO
+// sem faixa de blocos, mostra um resumo, com as sequências de blocos que
+//   têm algum valor diferente de zero (os que nunca foram escritos são zero)
+// o tamanho dos blocos deve ser o da página usada na simulação (opção -p do
+//   main e deste programa)
+
+// INCLUDES {{{1
+#include "geometria.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+// tamanho de um bloco (uma página), em valores
+int tam_pagina = GEOM_TAM_PAGINA;
+
+// AUXILIARES {{{1
+// aborta o programa com uma mensagem de erro
+void erro_brabo(char *msg)
+{
+  fprintf(stderr, "ERRO FATAL: %s\n", msg);
+  exit(1);
+}
+
+// lê o bloco 'bloco' da imagem para 'valores'; retorna false se não existe
+bool le_bloco(FILE *arq, int bloco, int valores[])
+{
+  if (fseek(arq, (long)bloco * tam_pagina * sizeof(int), SEEK_SET) != 0) {
+    return false;
+  }
+  return fread(valores, sizeof(int), tam_pagina, arq) == tam_pagina;
+}
+
+bool bloco_vazio(int valores[])
+{
+  for (int i = 0; i < tam_pagina; i++) {
+    if (valores[i] != 0) return false;
+  }
+  return true;
+}
+
+// RESUMO {{{1
+
+void mostra_resumo(FILE *arq, int n_blocos)
+{
+  int valores[tam_pagina];
+  int n_usados = 0;
+  int inicio = -1;
+  printf("blocos usados:\n");
+  for (int bloco = 0; bloco <= n_blocos; bloco++) {
+    bool usado = bloco < n_blocos && le_bloco(arq, bloco, valores)
+                 && !bloco_vazio(valores);
+    if (usado) {
+      n_usados++;
+      if (inicio == -1) inicio = bloco;
+    } else if (inicio != -1) {
+      if (inicio == bloco - 1) {
+        printf("  %d\n", inicio);
+      } else {
+        printf("  %d-%d\n", inicio, bloco - 1);
+      }
+      inicio = -1;
+    }
+  }
+  printf("%d de %d blocos de %d valores com conteúdo\n",
+         n_usados, n_blocos, tam_pagina);
+}
+
+// CONTEÚDO {{{1
+
+void mostra_blocos(FILE *arq, int primeiro, int n)
+{
+  int valores[tam_pagina];
+  for (int bloco = primeiro; bloco < primeiro + n; bloco++) {
+    if (!le_bloco(arq, bloco, valores)) {
+      erro_brabo("bloco fora da imagem");
+    }
+    printf("%6d [%7d]:", bloco, bloco * tam_pagina);
+    for (int i = 0; i < tam_pagina; i++) {
+      printf(" %6d", valores[i]);
+    }
+    printf("\n");
+  }
+}
+
+// PRINCIPAL {{{1
+
+int main(int argc, char *argv[argc])
+{
+  if (argc >= 3 && strcmp(argv[1], "-p") == 0) {
+    tam_pagina = atoi(argv[2]);
+    if (tam_pagina < 1) erro_brabo("tamanho de página inválido");
+    argv[2] = argv[0];
+    argv += 2;
+    argc -= 2;
+  }
+  if (argc < 2 || argc > 4) {
+    fprintf(stderr, "Uso: %s [-p tam_pagina] imagem [bloco [n]]\n", argv[0]);
+    fprintf(stderr, "  sem bloco, mostra os blocos com conteúdo\n");
+    fprintf(stderr, "  senão, mostra o conteúdo de n blocos (1 se omitido) "
+                    "a partir de bloco\n");
+    exit(1);
+  }
+  FILE *arq = fopen(argv[1], "rb");
+  if (arq == NULL) {
+    perror(argv[1]);
+    exit(1);
+  }
+  if (fseek(arq, 0, SEEK_END) != 0) erro_brabo("não consigo ver o tamanho");
+  long tam = ftell(arq) / sizeof(int);
+  int n_blocos = tam / tam_pagina;
+  printf("imagem '%s': %ld valores, %d blocos\n", argv[1], tam, n_blocos);
+
+  if (argc == 2) {
+    mostra_resumo(arq, n_blocos);
+  } else {
+    int primeiro = atoi(argv[2]);
+    int n = argc == 4 ? atoi(argv[3]) : 1;
+    if (primeiro < 0 || n < 1) erro_brabo("faixa de blocos inválida");
+    mostra_blocos(arq, primeiro, n);
+  }
+  fclose(arq);
+  return 0;
+}
+
+// vim: foldmethod=marker
@@ -0,0 +1,72 @@
+// instantaneo.h
+// formato do arquivo de instantâneo da memória
+// simulador de computador
+// so24b
+
+#ifndef INSTANTANEO_H
+#define INSTANTANEO_H
+
+// um instantâneo é gravado pelo SO quando o operador pede (comando S na
+//   console ou sinal SIGUSR1), e mostrado pelo programa mostra_instantaneo
+// o arquivo é binário, com inteiros no formato da máquina hospedeira, na
+//   seguinte ordem:
+//   - um cabeçalho (instantaneo_cab_t)
+//   - o conteúdo da memória principal (cab.tam_mem valores)
+//   - um instantaneo_quadro_t para cada quadro (cab.n_quadros)
+//   - para cada processo (cab.n_procs), um instantaneo_proc_t seguido de
+//       um instantaneo_pagina_t para cada página (proc.n_paginas)
+//   - a fila de páginas na ordem de carga (cab.n_fila instantaneo_fila_t)
+
+#define INSTANTANEO_MAGICO 0x4e49534f // "OSIN"
+#define INSTANTANEO_VERSAO 2
+
+typedef struct
+{
+  int magico;
+  int versao;
+  // instante (relógio de instruções) em que foi gravado
+  int agora;
+  int tam_pagina;
+  int tam_mem;
+  int n_quadros;
+  // primeiro quadro usado por processos
+  int primeiro_quadro;
+  int n_procs;
+  int n_fila;
+} instantaneo_cab_t;
+
+typedef struct
+{
+  int ocupado;
+  int pid;
+  int pagina;
+} instantaneo_quadro_t;
+
+typedef struct
+{
+  int pid;
+  int estado;
+  int pc;
+  int n_paginas;
+} instantaneo_proc_t;
+
+typedef struct
+{
+  // quadro onde a página está, ou -1 se não está na memória principal
+  int quadro;
+  int acessada;
+  int alterada;
+  int bloco_swap;
+  // de onde vem a página quando está ausente: 0 memória secundária,
+  //   1 programa, 2 zeros
+  int origem;
+} instantaneo_pagina_t;
+
+typedef struct
+{
+  int pid;
+  int pagina;
+  int quadro;
+} instantaneo_fila_t;
+
+#endif // INSTANTANEO_H
@@ -14,6 +14,7 @@ typedef enum {
   IRQ_SISTEMA,       // chamada de sistema
   // interrupções geradas por dispositivos de E/S
   IRQ_RELOGIO,       // interrupção causada pelo relógio
+  IRQ_DISCO,         // interrupção causada pelo disco (pedido concluído)
   // interrupções de E/S ainda não implementadas
   IRQ_TECLADO,       // interrupção causada pelo teclado
   IRQ_TELA,          // interrupção causada pela tela
@@ -0,0 +1,87 @@
+; le_linha.asm
+; programa de exemplo para SO
+; testa a chamada SO_LE_LINHA
+
+; lê 5 linhas de até 10 caracteres, e escreve cada uma seguida de '|'; uma
+;   linha mais longa é lida em pedaços; depois lê dois caracteres com SO_LE
+;   e escreve os dois
+; para não depender do que é digitado, a entrada do terminal pode vir de um
+;   arquivo (opção -i do main)
+N        define 5   ; quantas linhas ler
+MAX      define 10  ; máximo de caracteres de cada leitura
+
+         desv main
+
+; chamadas de sistema (ver so.h)
+SO_LE          define 1
+SO_MATA_PROC   define 8
+SO_ESCR_STR    define 12
+SO_LE_LINHA    define 13
+
+main
+         chama linhas
+         chama dois_car
+         chama morre
+         para
+
+morre    espaco 1
+         cargi 0
+         trax
+         cargi SO_MATA_PROC
+         chamas
+         ret morre
+
+; lê e escreve N linhas
+linhas   espaco 1
+         cargi N
+         armm li_cont
+li_1     cargi li_le
+         trax
+         cargi SO_LE_LINHA
+         chamas
+         ; escreve os caracteres lidos (o retorno é o número deles)
+         armm li_n
+         cargi li_esc
+         trax
+         cargi SO_ESCR_STR
+         chamas
+         cargi li_fim
+         trax
+         cargi SO_ESCR_STR
+         chamas
+         cargm li_cont
+         sub um
+         armm li_cont
+         desvnz li_1
+         ret linhas
+li_cont  espaco 1
+; argumentos de SO_LE_LINHA: endereço e máximo de caracteres
+li_le    valor li_buf
+         valor MAX
+; argumentos de SO_ESCR_STR: endereço e número de caracteres lidos
+li_esc   valor li_buf
+li_n     espaco 1
+li_fim   valor li_bar
+         valor 1
+li_bar   valor '|'
+li_buf   espaco MAX
+
+; lê dois caracteres com SO_LE e escreve os dois
+dois_car espaco 1
+         cargi SO_LE
+         chamas
+         armm dc_car
+         cargi SO_LE
+         chamas
+         armm dc_car2
+         cargi dc_arg
+         trax
+         cargi SO_ESCR_STR
+         chamas
+         ret dois_car
+; argumentos de SO_ESCR_STR: endereço e número de caracteres
+dc_arg   valor dc_car
+         valor 2
+dc_car   espaco 1
+dc_car2  espaco 1
+um       valor 1
@@ -8,18 +8,20 @@
 #include "mmu.h"
 #include "cpu.h"
 #include "relogio.h"
+#include "disco.h"
 #include "console.h"
 #include "terminal.h"
 #include "es.h"
 #include "dispositivos.h"
 #include "so.h"
+#include "geometria.h"
 
 #include <stdio.h>
 #include <stdlib.h>
-
-// constantes
-#define MEM_TAM 1000      // tamanho da memória principal
-#define TAM_DISCO 100000 // tamanho da memória secundária
+#include <unistd.h>
+#include <limits.h>
+#include <string.h>
+#include <ctype.h>
 
 // estrutura com os componentes do computador simulado
 typedef struct
@@ -29,21 +31,39 @@ typedef struct
   mmu_t *mmu;
   cpu_t *cpu;
   relogio_t *relogio;
+  disco_t *disco;
   console_t *console;
   es_t *es;
   controle_t *controle;
 } hardware_t;
 
-static void cria_hardware(hardware_t *hw)
+// cria o hardware, com as memórias e a página do tamanho definido em
+//   'geometria'; a memória secundária fica no arquivo 'imagem_disco', se
+//   não for NULL
+// retorna false se não conseguir criar a imagem do disco
+static bool cria_hardware(hardware_t *hw, geometria_t *geometria, char *imagem_disco)
 {
   // cria a memória e a MMU
-  hw->mem = mem_cria(MEM_TAM);
-  hw->mem_secundaria = mem_cria(TAM_DISCO);
-  hw->mmu = mmu_cria(hw->mem);
+  hw->mem = mem_cria(geometria->tam_mem);
+  if (imagem_disco != NULL)
+  {
+    hw->mem_secundaria = mem_cria_arquivo(imagem_disco, geometria->tam_disco);
+    if (hw->mem_secundaria == NULL)
+    {
+      perror(imagem_disco);
+      return false;
+    }
+  }
+  else
+  {
+    hw->mem_secundaria = mem_cria(geometria->tam_disco);
+  }
+  hw->mmu = mmu_cria(hw->mem, geometria->tam_pagina);
 
   // cria dispositivos de E/S
   hw->console = console_cria();
   hw->relogio = relogio_cria();
+  hw->disco = disco_cria(hw->mem_secundaria, hw->mem);
 
   // cria o controlador de E/S e registra os dispositivos
   //   por exemplo, o dispositivo 8 do controlador de E/S (e da CPU) será o
@@ -79,13 +99,24 @@ static void cria_hardware(hardware_t *hw)
   es_registra_dispositivo(hw->es, D_RELOGIO_REAL, hw->relogio, 1, relogio_leitura, NULL);
   es_registra_dispositivo(hw->es, D_RELOGIO_TIMER, hw->relogio, 2, relogio_leitura, relogio_escrita);
   es_registra_dispositivo(hw->es, D_RELOGIO_INTERRUPCAO, hw->relogio, 3, relogio_leitura, relogio_escrita);
+  // parâmetros do pedido, comando, pedidos concluídos, interrupção e posição
+  //   da cabeça do disco
+  es_registra_dispositivo(hw->es, D_DISCO_END_MIDIA, hw->disco, 0, NULL, disco_escrita);
+  es_registra_dispositivo(hw->es, D_DISCO_END_MEM, hw->disco, 1, NULL, disco_escrita);
+  es_registra_dispositivo(hw->es, D_DISCO_TAMANHO, hw->disco, 2, NULL, disco_escrita);
+  es_registra_dispositivo(hw->es, D_DISCO_ETIQUETA, hw->disco, 3, NULL, disco_escrita);
+  es_registra_dispositivo(hw->es, D_DISCO_COMANDO, hw->disco, 4, disco_leitura, disco_escrita);
+  es_registra_dispositivo(hw->es, D_DISCO_CONCLUIDO, hw->disco, 5, disco_leitura, NULL);
+  es_registra_dispositivo(hw->es, D_DISCO_INTERRUPCAO, hw->disco, 6, disco_leitura, NULL);
+  es_registra_dispositivo(hw->es, D_DISCO_CABECA, hw->disco, 7, disco_leitura, NULL);
 
   // cria a unidade de execução e inicializa com a MMU e E/S
   hw->cpu = cpu_cria(hw->mmu, hw->es);
 
-  // cria o controlador da CPU e inicializa com a unidade de execução, a console e
-  //   o relógio
-  hw->controle = controle_cria(hw->cpu, hw->console, hw->relogio);
+  // cria o controlador da CPU e inicializa com a unidade de execução, a console,
+  //   o relógio e o disco
+  hw->controle = controle_cria(hw->cpu, hw->console, hw->relogio, hw->disco);
+  return true;
 }
 
 static void destroi_hardware(hardware_t *hw)
@@ -94,20 +125,291 @@ static void destroi_hardware(hardware_t *hw)
   cpu_destroi(hw->cpu);
   es_destroi(hw->es);
   relogio_destroi(hw->relogio);
+  disco_destroi(hw->disco);
   console_destroi(hw->console);
   mmu_destroi(hw->mmu);
   mem_destroi(hw->mem);
+  mem_destroi(hw->mem_secundaria);
+}
+
+// número de terminais (A a D)
+#define N_TERM 4
+
+// opções da linha de comando
+typedef struct
+{
+  // algoritmo de substituição de páginas (NULL para o padrão do SO)
+  char *troca;
+  // arquivo onde gravar o rastro de referências a páginas (NULL para não gravar)
+  char *rastro;
+  // arquivo com a imagem da memória secundária (NULL para memória comum)
+  char *disco;
+  // escalonamento dos pedidos ao disco (NULL para o padrão do SO)
+  char *esc_disco;
+  // terminais no modo rápido
+  bool term_rapido;
+  // para cada terminal, arquivo de onde vem a entrada e intervalo entre os
+  //   caracteres, e arquivo que recebe a saída (NULL se não tiver)
+  char *entrada[N_TERM];
+  int intervalo[N_TERM];
+  char *saida[N_TERM];
+  // tamanhos das memórias e da página
+  geometria_t geometria;
+} opcoes_t;
+
+// arquivo onde são gravados os instantâneos da memória
+#define ARQ_INSTANTANEO "instantaneo.bin"
+
+// chamada pelo controlador quando o operador pede um instantâneo
+static void grava_instantaneo(void *arg)
+{
+  so_grava_instantaneo(arg, ARQ_INSTANTANEO);
+}
+
+static void uso(char *nome)
+{
+  fprintf(stderr, "uso: %s [-t algoritmo] [-r arquivo] [-d imagem] [-e escalonador]\n"
+                  "         [-p tam_pagina] [-m tam_mem] [-q quadros] [-s tam_disco]\n"
+                  "         [-g paginas] [-f] [-i t:arquivo[:intervalo]] [-o t:arquivo]\n", nome);
+  fprintf(stderr, "  -t algoritmo  algoritmo de substituição de páginas (fifo, segunda_chance,\n");
+  fprintf(stderr, "                clock, wsclock, envelhecimento, nfu, lfu)\n");
+  fprintf(stderr, "  -r arquivo    grava o rastro de referências a páginas (para simula_troca)\n");
+  fprintf(stderr, "  -d imagem     mantém a memória secundária no arquivo 'imagem' (para\n");
+  fprintf(stderr, "                inspeciona_disco)\n");
+  fprintf(stderr, "  -e escalonador  ordem de atendimento dos pedidos ao disco (fcfs, sstf,\n");
+  fprintf(stderr, "                scan, clook, deadline)\n");
+  fprintf(stderr, "  -p tam_pagina tamanho da página, em palavras (padrão %d)\n", GEOM_TAM_PAGINA);
+  fprintf(stderr, "  -m tam_mem    tamanho da memória principal (padrão %d)\n", GEOM_TAM_MEM);
+  fprintf(stderr, "  -q quadros    número de quadros da memória principal usados (padrão:\n");
+  fprintf(stderr, "                todos os que cabem nela)\n");
+  fprintf(stderr, "  -s tam_disco  tamanho da memória secundária (padrão %d)\n", GEOM_TAM_DISCO);
+  fprintf(stderr, "  -g paginas    páginas em uma página grande, 0 para não usar (padrão %d)\n",
+          GEOM_PAGINAS_GRANDES);
+  fprintf(stderr, "  -f            terminais rápidos: rolam e limpam a saída de uma vez, sem\n");
+  fprintf(stderr, "                ocupar a tela um caractere por vez\n");
+  fprintf(stderr, "  -i t:arquivo[:intervalo]  a entrada do terminal 't' (a a d) vem também do\n");
+  fprintf(stderr, "                arquivo (ou pipe), um caractere a cada 'intervalo' instruções\n");
+  fprintf(stderr, "                ou, sem intervalo, sempre que houver espaço\n");
+  fprintf(stderr, "  -o t:arquivo  grava no arquivo o que é escrito na tela do terminal 't'\n");
+}
+
+// converte o argumento de uma opção numérica; retorna false se não for um
+//   número
+static bool pega_numero(char *arg, int *pnum)
+{
+  char *fim;
+  long num = strtol(arg, &fim, 10);
+  if (fim == arg || *fim != '\0' || num < INT_MIN || num > INT_MAX)
+    return false;
+  *pnum = num;
+  return true;
 }
 
-int main()
+// converte o argumento de uma opção de terminal, na forma t:arquivo (ou
+//   t:arquivo:intervalo, se 'pintervalo' não for NULL); retorna o número do
+//   terminal, ou -1 se o argumento for inválido
+static int pega_terminal(char *arg, char **parquivo, int *pintervalo)
+{
+  int terminal = tolower(arg[0]) - 'a';
+  if (terminal < 0 || terminal >= N_TERM || arg[1] != ':' || arg[2] == '\0')
+    return -1;
+  *parquivo = &arg[2];
+  if (pintervalo != NULL)
+  {
+    *pintervalo = 0;
+    char *dois_pontos = strrchr(*parquivo, ':');
+    if (dois_pontos != NULL && pega_numero(dois_pontos + 1, pintervalo))
+    {
+      if (*pintervalo < 0 || dois_pontos == *parquivo)
+        return -1;
+      *dois_pontos = '\0';
+    }
+  }
+  return terminal;
+}
+
+static bool pega_opcoes(int argc, char *argv[], opcoes_t *opcoes)
+{
+  opcoes->troca = NULL;
+  opcoes->rastro = NULL;
+  opcoes->disco = NULL;
+  opcoes->esc_disco = NULL;
+  opcoes->term_rapido = false;
+  for (int t = 0; t < N_TERM; t++)
+  {
+    opcoes->entrada[t] = NULL;
+    opcoes->intervalo[t] = 0;
+    opcoes->saida[t] = NULL;
+  }
+  geometria_padrao(&opcoes->geometria);
+  int opt;
+  while ((opt = getopt(argc, argv, "t:r:d:e:p:m:q:s:g:fi:o:")) != -1)
+  {
+    switch (opt)
+    {
+    case 't':
+      opcoes->troca = optarg;
+      break;
+    case 'r':
+      opcoes->rastro = optarg;
+      break;
+    case 'd':
+      opcoes->disco = optarg;
+      break;
+    case 'e':
+      opcoes->esc_disco = optarg;
+      break;
+    case 'p':
+      if (!pega_numero(optarg, &opcoes->geometria.tam_pagina))
+        return false;
+      break;
+    case 'm':
+      if (!pega_numero(optarg, &opcoes->geometria.tam_mem))
+        return false;
+      break;
+    case 'q':
+      if (!pega_numero(optarg, &opcoes->geometria.n_quadros))
+        return false;
+      break;
+    case 's':
+      if (!pega_numero(optarg, &opcoes->geometria.tam_disco))
+        return false;
+      break;
+    case 'g':
+      if (!pega_numero(optarg, &opcoes->geometria.paginas_grandes))
+        return false;
+      break;
+    case 'f':
+      opcoes->term_rapido = true;
+      break;
+    case 'i':
+    {
+      char *arquivo;
+      int intervalo;
+      int t = pega_terminal(optarg, &arquivo, &intervalo);
+      if (t < 0)
+        return false;
+      opcoes->entrada[t] = arquivo;
+      opcoes->intervalo[t] = intervalo;
+      break;
+    }
+    case 'o':
+    {
+      char *arquivo;
+      int t = pega_terminal(optarg, &arquivo, NULL);
+      if (t < 0)
+        return false;
+      opcoes->saida[t] = arquivo;
+      break;
+    }
+    default:
+      return false;
+    }
+  }
+  return optind == argc;
+}
+
+// abre os arquivos de entrada e saída dos terminais pedidos nas opções (os
+//   outros ficam NULL); retorna false se não conseguir abrir algum
+static bool abre_arquivos_terminais(opcoes_t *opcoes, FILE *entrada[N_TERM], FILE *saida[N_TERM])
+{
+  for (int t = 0; t < N_TERM; t++)
+  {
+    entrada[t] = NULL;
+    saida[t] = NULL;
+  }
+  for (int t = 0; t < N_TERM; t++)
+  {
+    if (opcoes->entrada[t] != NULL)
+    {
+      entrada[t] = fopen(opcoes->entrada[t], "r");
+      if (entrada[t] == NULL)
+      {
+        perror(opcoes->entrada[t]);
+        return false;
+      }
+    }
+    if (opcoes->saida[t] != NULL)
+    {
+      saida[t] = fopen(opcoes->saida[t], "w");
+      if (saida[t] == NULL)
+      {
+        perror(opcoes->saida[t]);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int main(int argc, char *argv[])
 {
   hardware_t hw;
   so_t *so;
+  opcoes_t opcoes;
+
+  if (!pega_opcoes(argc, argv, &opcoes))
+  {
+    uso(argv[0]);
+    return 1;
+  }
+  char *erro_geometria = geometria_confere(&opcoes.geometria);
+  if (erro_geometria == NULL)
+  {
+    erro_geometria = so_confere_geometria(&opcoes.geometria);
+  }
+  if (erro_geometria != NULL)
+  {
+    fprintf(stderr, "%s: %s\n", argv[0], erro_geometria);
+    return 1;
+  }
+  FILE *rastro = NULL;
+  if (opcoes.rastro != NULL)
+  {
+    rastro = fopen(opcoes.rastro, "w");
+    if (rastro == NULL)
+    {
+      perror(opcoes.rastro);
+      return 1;
+    }
+  }
+  FILE *entrada[N_TERM], *saida[N_TERM];
+  if (!abre_arquivos_terminais(&opcoes, entrada, saida))
+  {
+    return 1;
+  }
 
   // cria o hardware
-  cria_hardware(&hw);
+  if (!cria_hardware(&hw, &opcoes.geometria, opcoes.disco))
+  {
+    return 1;
+  }
+  mmu_define_rastro(hw.mmu, rastro);
+  for (int t = 0; t < N_TERM; t++)
+  {
+    terminal_t *terminal = console_terminal(hw.console, 'A' + t);
+    terminal_define_rapido(terminal, opcoes.term_rapido);
+    terminal_define_entrada(terminal, entrada[t], hw.relogio, opcoes.intervalo[t]);
+    terminal_define_saida(terminal, saida[t]);
+  }
   // cria o sistema operacional
-  so = so_cria(hw.cpu, hw.mem, hw.mem_secundaria, hw.mmu, hw.es, hw.console);
+  so = so_cria(hw.cpu, hw.mem, hw.mem_secundaria, hw.mmu, hw.es, hw.console, &opcoes.geometria);
+  if (so == NULL)
+  {
+    destroi_hardware(&hw);
+    fprintf(stderr, "%s: não foi possível criar o SO\n", argv[0]);
+    return 1;
+  }
+  if (opcoes.troca != NULL && !so_define_troca(so, opcoes.troca))
+  {
+    console_printf("algoritmo de substituição '%s' desconhecido", opcoes.troca);
+  }
+  if (opcoes.esc_disco != NULL && !so_define_escalonador_disco(so, opcoes.esc_disco))
+  {
+    console_printf("escalonador do disco '%s' desconhecido", opcoes.esc_disco);
+  }
+
+  controle_define_instantaneo(hw.controle, grava_instantaneo, so);
 
   // executa o laço principal do controlador
   controle_laco(hw.controle);
@@ -115,4 +417,15 @@ int main()
   // destroi tudo
   so_destroi(so);
   destroi_hardware(&hw);
+  if (rastro != NULL)
+  {
+    fclose(rastro);
+  }
+  for (int t = 0; t < N_TERM; t++)
+  {
+    if (entrada[t] != NULL)
+      fclose(entrada[t]);
+    if (saida[t] != NULL)
+      fclose(saida[t]);
+  }
 }
@@ -6,12 +6,19 @@
 #include "memoria.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 // tipo de dados para representar uma região de memória
 struct mem_t {
   int tam;
   int *conteudo;
+  // descritor do arquivo mapeado em 'conteudo', ou -1 se não tem arquivo
+  int fd;
 };
 
 mem_t *mem_cria(int tam)
@@ -24,14 +31,62 @@ mem_t *mem_cria(int tam)
   assert(self->conteudo != NULL);
 
   self->tam = tam;
+  self->fd = -1;
 
   return self;
 }
 
+mem_t *mem_cria_arquivo(char *nome, int tam)
+{
+  int fd = open(nome, O_RDWR | O_CREAT, 0644);
+  if (fd < 0) return NULL;
+
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    return NULL;
+  }
+  if (st.st_size < (off_t)tam * (off_t)sizeof(int)) {
+    if (ftruncate(fd, (off_t)tam * (off_t)sizeof(int)) < 0) {
+      close(fd);
+      return NULL;
+    }
+  } else {
+    tam = st.st_size / sizeof(int);
+  }
+
+  int *conteudo = mmap(NULL, tam * sizeof(int), PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd, 0);
+  if (conteudo == MAP_FAILED) {
+    close(fd);
+    return NULL;
+  }
+
+  mem_t *self = malloc(sizeof(*self));
+  assert(self != NULL);
+  self->tam = tam;
+  self->conteudo = conteudo;
+  self->fd = fd;
+  return self;
+}
+
+err_t mem_sincroniza(mem_t *self)
+{
+  if (self->fd == -1) return ERR_OK;
+  if (msync(self->conteudo, self->tam * sizeof(int), MS_SYNC) < 0) {
+    return ERR_OP_INV;
+  }
+  return ERR_OK;
+}
+
 void mem_destroi(mem_t *self)
 {
   if (self != NULL) {
-    if (self->conteudo != NULL) {
+    if (self->fd != -1) {
+      mem_sincroniza(self);
+      munmap(self->conteudo, self->tam * sizeof(int));
+      close(self->fd);
+    } else if (self->conteudo != NULL) {
       free(self->conteudo);
     }
     free(self);
@@ -69,3 +124,46 @@ err_t mem_escreve(mem_t *self, int endereco, int valor)
   }
   return err;
 }
+
+// função auxiliar, verifica se todos os endereços do bloco são válidos
+static err_t verifica_bloco(mem_t *self, int endereco, int n)
+{
+  if (n < 0 || endereco < 0 || endereco > self->tam - n) {
+    return ERR_END_INV;
+  }
+  return ERR_OK;
+}
+
+err_t mem_copia_bloco(mem_t *dst, int dst_end, mem_t *src, int src_end, int n)
+{
+  if (verifica_bloco(dst, dst_end, n) != ERR_OK
+      || verifica_bloco(src, src_end, n) != ERR_OK) {
+    return ERR_END_INV;
+  }
+  int *pdst = dst->conteudo + dst_end;
+  int *psrc = src->conteudo + src_end;
+  if (dst == src) {
+    memmove(pdst, psrc, n * sizeof(int));
+  } else {
+    memcpy(pdst, psrc, n * sizeof(int));
+  }
+  return ERR_OK;
+}
+
+err_t mem_le_bloco(mem_t *self, int endereco, int n, int valores[n])
+{
+  err_t err = verifica_bloco(self, endereco, n);
+  if (err == ERR_OK) {
+    memcpy(valores, self->conteudo + endereco, n * sizeof(int));
+  }
+  return err;
+}
+
+err_t mem_escreve_bloco(mem_t *self, int endereco, int n, int valores[n])
+{
+  err_t err = verifica_bloco(self, endereco, n);
+  if (err == ERR_OK) {
+    memcpy(self->conteudo + endereco, valores, n * sizeof(int));
+  }
+  return err;
+}
@@ -16,10 +16,24 @@ typedef struct mem_t mem_t;
 //   as operações sobre essa memória
 mem_t *mem_cria(int tam);
 
+// cria uma região de memória cujo conteúdo é o arquivo 'nome', mapeado na
+//   memória do simulador (imagem de disco); o conteúdo sobrevive ao fim da
+//   simulação e pode ser examinado com o programa inspeciona_disco
+// o arquivo é criado se não existir, e aumentado (sem ocupar espaço no disco
+//   do hospedeiro, é um arquivo esparso) se tiver menos de 'tam' valores;
+//   se tiver mais, a região tem o tamanho do arquivo
+// retorna NULL em caso de erro
+mem_t *mem_cria_arquivo(char *nome, int tam);
+
 // destrói uma região de memória
 // nenhuma outra operação pode ser realizada na região após esta chamada
 void mem_destroi(mem_t *self);
 
+// garante que as alterações na região estão gravadas no arquivo, se ela foi
+//   criada com mem_cria_arquivo (não faz nada para as outras)
+// retorna ERR_OP_INV se não conseguir gravar
+err_t mem_sincroniza(mem_t *self);
+
 // retorna o tamanho da região de memória (número de valores que comporta)
 int mem_tam(mem_t *self);
 
@@ -31,4 +45,21 @@ err_t mem_le(mem_t *self, int endereco, int *pvalor);
 // retorna erro ERR_END_INV se endereço inválido
 err_t mem_escreve(mem_t *self, int endereco, int valor);
 
+// operações sobre blocos de valores consecutivos, com uma única verificação
+//   de endereço para o bloco todo
+// retornam erro ERR_END_INV (e não copiam nada) se algum endereço do bloco
+//   for inválido
+
+// copia 'n' valores da memória 'src', a partir do endereço 'src_end', para
+//   a memória 'dst', a partir do endereço 'dst_end'
+// 'src' e 'dst' podem ser a mesma memória, inclusive com blocos sobrepostos
+err_t mem_copia_bloco(mem_t *dst, int dst_end, mem_t *src, int src_end, int n);
+
+// copia para 'valores' os 'n' valores a partir do endereço 'endereco'
+err_t mem_le_bloco(mem_t *self, int endereco, int n, int valores[n]);
+
+// copia os 'n' valores de 'valores' para a memória, a partir do endereço
+//   'endereco'
+err_t mem_escreve_bloco(mem_t *self, int endereco, int n, int valores[n]);
+
 #endif // MEMORIA_H
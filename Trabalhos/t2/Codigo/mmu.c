@@ -11,17 +11,29 @@
 struct mmu_t {
   // memória física
   mem_t *mem;
+  // tamanho de uma página, em palavras
+  int tam_pagina;
   // tabela de páginas
   tabpag_t *tabpag;
+  // rastro de referências (NULL se não estiver sendo gerado)
+  FILE *rastro;
+  int pid;
+  // última referência registrada
+  int ult_pid, ult_pagina, ult_op;
 };
 
-mmu_t *mmu_cria(mem_t *mem)
+mmu_t *mmu_cria(mem_t *mem, int tam_pagina)
 {
   mmu_t *self;
   self = malloc(sizeof(*self));
   assert(self != NULL);
+  assert(tam_pagina > 0);
   self->mem = mem;
+  self->tam_pagina = tam_pagina;
   self->tabpag = NULL;
+  self->rastro = NULL;
+  self->pid = 0;
+  self->ult_pid = -1;
   return self;
 }
 
@@ -33,22 +45,51 @@ void mmu_destroi(mmu_t *self)
   }
 }
 
+int mmu_tam_pagina(mmu_t *self)
+{
+  return self->tam_pagina;
+}
+
 void mmu_define_tabpag(mmu_t *self, tabpag_t *tabpag)
 {
   self->tabpag = tabpag;
 }
 
+void mmu_define_rastro(mmu_t *self, FILE *rastro)
+{
+  self->rastro = rastro;
+  self->ult_pid = -1;
+}
+
+void mmu_define_pid(mmu_t *self, int pid)
+{
+  self->pid = pid;
+}
+
+// registra no rastro uma referência à página 'pagina'
+static void mmu__registra(mmu_t *self, int pagina, char op)
+{
+  if (self->rastro == NULL)
+    return;
+  if (self->pid == self->ult_pid && pagina == self->ult_pagina && op == self->ult_op)
+    return;
+  fprintf(self->rastro, "%d %d %c\n", self->pid, pagina, op);
+  self->ult_pid = self->pid;
+  self->ult_pagina = pagina;
+  self->ult_op = op;
+}
+
 // tradur o endereço virtual 'endvirt', colocando o endereço físico
 //   correspondente em 'pendfis'.
 // retorna ERR_OK ou um erro se a tradução não for possível
 static err_t mmu__traduz(mmu_t *self, int endvirt, int *pendfis)
 {
-  int pagina = endvirt / TAM_PAGINA;
-  int deslocamento = endvirt % TAM_PAGINA;
+  int pagina = endvirt / self->tam_pagina;
+  int deslocamento = endvirt % self->tam_pagina;
   int quadro;
   err_t err = tabpag_traduz(self->tabpag, pagina, &quadro);
   if (err == ERR_OK) {
-    *pendfis = quadro * TAM_PAGINA + deslocamento;
+    *pendfis = quadro * self->tam_pagina + deslocamento;
   }
   return err;
 }
@@ -65,7 +106,8 @@ err_t mmu_le(mmu_t *self, int endvirt, int *pvalor, cpu_modo_t modo)
   if (err == ERR_OK) {
     err = mem_le(self->mem, endfis, pvalor);
     if (err == ERR_OK) {
-      tabpag_marca_bit_acesso(self->tabpag, endvirt / TAM_PAGINA, false);
+      tabpag_marca_bit_acesso(self->tabpag, endvirt / self->tam_pagina, false);
+      mmu__registra(self, endvirt / self->tam_pagina, 'l');
     }
   }
   return err;
@@ -80,10 +122,14 @@ err_t mmu_escreve(mmu_t *self, int endvirt, int valor, cpu_modo_t modo)
   }
   int endfis;
   err_t err = mmu__traduz(self, endvirt, &endfis);
+  if (err == ERR_OK && tabpag_somente_leitura(self->tabpag, endvirt / self->tam_pagina)) {
+    err = ERR_PAG_PROTEGIDA;
+  }
   if (err == ERR_OK) {
     err = mem_escreve(self->mem, endfis, valor);
     if (err == ERR_OK) {
-      tabpag_marca_bit_acesso(self->tabpag, endvirt / TAM_PAGINA, true);
+      tabpag_marca_bit_acesso(self->tabpag, endvirt / self->tam_pagina, true);
+      mmu__registra(self, endvirt / self->tam_pagina, 'e');
     }
   }
   return err;
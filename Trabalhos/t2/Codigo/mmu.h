@@ -19,25 +19,39 @@ typedef struct mmu_t mmu_t;
 #include "err.h"
 #include "cpu.h"
 
-// tamanho de uma página, em palavras de memória
-// t2: pode ser alterado para comparar configurações diferentes
-#define TAM_PAGINA 10
+#include <stdio.h>
 
 // cria uma MMU para gerenciar acessos à memória
 // retorna um ponteiro para um descritor, que deverá ser usado em todas
 //   as operações nessa MMU
-// recebe 'mem', a memória física que será gerenciada
+// recebe 'mem', a memória física que será gerenciada, e o tamanho de uma
+//   página, em palavras de memória (ver geometria.h)
 // mata o programa em caso de erro (malloc)
-mmu_t *mmu_cria(mem_t *mem);
+mmu_t *mmu_cria(mem_t *mem, int tam_pagina);
 
 // destrói uma MMU
 // nenhuma outra operação pode ser realizada na MMU após esta chamada
 void mmu_destroi(mmu_t *self);
 
+// retorna o tamanho de uma página, em palavras de memória
+int mmu_tam_pagina(mmu_t *self);
+
 // define a tabela de páginas a usar nas próximas traduções
 // se tabpag for NULL, os acessos serão repassados sem alteração à memória
 void mmu_define_tabpag(mmu_t *self, tabpag_t *tabpag);
 
+// define o arquivo onde serão registradas as referências a páginas feitas
+//   com tradução de endereços (o rastro de referências)
+// cada referência bem sucedida gera uma linha "pid página op", onde op é
+//   'l' para leitura e 'e' para escrita; referências consecutivas iguais
+//   são registradas uma vez só
+// se rastro for NULL, as referências não são registradas
+void mmu_define_rastro(mmu_t *self, FILE *rastro);
+
+// define a identificação do processo dono da tabela de páginas em uso,
+//   para o rastro de referências
+void mmu_define_pid(mmu_t *self, int pid);
+
 // coloca na posição apontada por 'pvalor' o valor que está na memória
 //   no endereço físico correspondente ao endereço virtual 'endvirt'
 // marca a página como acessada se o acesso for bem sucedido
@@ -52,7 +66,8 @@ err_t mmu_le(mmu_t *self, int endvirt, int *pvalor, cpu_modo_t modo);
 //   virtual 'endvirt'
 // marca a página como acessada e alterada se o acesso for bem sucedido
 // retorna erro se acesso não for possível, por um erro de tradução
-//   (ver tabpag_traduz) ou de memória (ver mem_escreve)
+//   (ver tabpag_traduz), por a página ser somente para leitura
+//   (ERR_PAG_PROTEGIDA) ou de memória (ver mem_escreve)
 // se o acesso for feito em modo supervisor, ou se a mmu não tiver tabela de
 //   página definida, trata 'endvirt' como endereço físico, repassa o acesso
 //   à memória sem tradução
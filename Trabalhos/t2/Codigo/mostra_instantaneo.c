@@ -0,0 +1,137 @@
+// mostra_instantaneo.c
+// mostra um instantâneo da memória gravado pelo SO
+// simulador de computador
+// so24b
+
+// lê o arquivo gravado quando o operador pede um instantâneo (comando S na
+//   console do simulador, ou sinal SIGUSR1) e mostra, em texto, a memória
+//   principal quadro a quadro, as tabelas de páginas dos processos e a fila
+//   de páginas; o formato do arquivo está em instantaneo.h
+
+// INCLUDES {{{1
+#include "instantaneo.h"
+#include "so.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+// AUXILIARES {{{1
+// aborta o programa com uma mensagem de erro
+void erro_brabo(char *msg)
+{
+  fprintf(stderr, "ERRO FATAL: %s\n", msg);
+  exit(1);
+}
+
+// lê 'n' estruturas de tamanho 'tam', ou aborta
+void le(FILE *arq, void *dados, int tam, int n)
+{
+  if (fread(dados, tam, n, arq) != n) erro_brabo("arquivo truncado");
+}
+
+char *nome_estado(int estado)
+{
+  static char *nomes[ESTADO_N] = {
+    [ESTADO_EXECUTANDO] = "EXECUTANDO",
+    [ESTADO_PRONTO]     = "PRONTO",
+    [ESTADO_BLOQUEADO]  = "BLOQUEADO",
+    [ESTADO_MORTO]      = "MORTO",
+    [ESTADO_SUSPENSO]   = "SUSPENSO",
+  };
+  if (estado < 0 || estado >= ESTADO_N) return "?";
+  return nomes[estado];
+}
+
+// PARTES DO INSTANTÂNEO {{{1
+
+void mostra_memoria(FILE *arq, instantaneo_cab_t *cab)
+{
+  int *mem = malloc(cab->tam_mem * sizeof(int));
+  if (mem == NULL) erro_brabo("sem memória");
+  le(arq, mem, sizeof(int), cab->tam_mem);
+  instantaneo_quadro_t *quadros = malloc(cab->n_quadros * sizeof(*quadros));
+  if (quadros == NULL) erro_brabo("sem memória");
+  le(arq, quadros, sizeof(*quadros), cab->n_quadros);
+
+  printf("\nMEMÓRIA PRINCIPAL (%d quadros de %d valores, processos a partir do %d)\n",
+         cab->n_quadros, cab->tam_pagina, cab->primeiro_quadro);
+  for (int q = 0; q < cab->n_quadros; q++) {
+    if (q < cab->primeiro_quadro) {
+      printf("%4d  SO          :", q);
+    } else if (quadros[q].ocupado) {
+      printf("%4d  p%-3d pág %-3d:", q, quadros[q].pid, quadros[q].pagina);
+    } else {
+      printf("%4d  livre       :\n", q);
+      continue;
+    }
+    for (int i = 0; i < cab->tam_pagina; i++) {
+      int end = q * cab->tam_pagina + i;
+      if (end < cab->tam_mem) printf(" %6d", mem[end]);
+    }
+    printf("\n");
+  }
+  free(quadros);
+  free(mem);
+}
+
+void mostra_processos(FILE *arq, instantaneo_cab_t *cab)
+{
+  printf("\nTABELAS DE PÁGINAS\n");
+  for (int p = 0; p < cab->n_procs; p++) {
+    instantaneo_proc_t proc;
+    le(arq, &proc, sizeof(proc), 1);
+    printf("processo %d, %s, PC=%d, %d páginas\n",
+           proc.pid, nome_estado(proc.estado), proc.pc, proc.n_paginas);
+    for (int pag = 0; pag < proc.n_paginas; pag++) {
+      instantaneo_pagina_t ip;
+      le(arq, &ip, sizeof(ip), 1);
+      printf("  pág %3d  bloco %5d  ", pag, ip.bloco_swap);
+      if (ip.quadro == -1) {
+        char *origens[] = { "disco", "programa", "zeros" };
+        printf("ausente (%s)\n", origens[ip.origem]);
+      } else {
+        printf("quadro %3d %c%c\n", ip.quadro,
+               ip.acessada ? 'A' : '-', ip.alterada ? 'M' : '-');
+      }
+    }
+  }
+}
+
+void mostra_fila(FILE *arq, instantaneo_cab_t *cab)
+{
+  printf("\nFILA DE PÁGINAS (%d)\n", cab->n_fila);
+  for (int i = 0; i < cab->n_fila; i++) {
+    instantaneo_fila_t f;
+    le(arq, &f, sizeof(f), 1);
+    printf("  %3d: p%d pág %d quadro %d\n", i, f.pid, f.pagina, f.quadro);
+  }
+}
+
+// PRINCIPAL {{{1
+
+int main(int argc, char *argv[argc])
+{
+  if (argc != 2) {
+    fprintf(stderr, "Uso: %s instantaneo\n", argv[0]);
+    exit(1);
+  }
+  FILE *arq = fopen(argv[1], "rb");
+  if (arq == NULL) {
+    perror(argv[1]);
+    exit(1);
+  }
+  instantaneo_cab_t cab;
+  le(arq, &cab, sizeof(cab), 1);
+  if (cab.magico != INSTANTANEO_MAGICO) erro_brabo("não é um instantâneo");
+  if (cab.versao != INSTANTANEO_VERSAO) erro_brabo("versão desconhecida");
+
+  printf("instantâneo no instante %d: %d processos\n", cab.agora, cab.n_procs);
+  mostra_memoria(arq, &cab);
+  mostra_processos(arq, &cab);
+  mostra_fila(arq, &cab);
+  fclose(arq);
+  return 0;
+}
+
+// vim: foldmethod=marker
@@ -15,6 +15,7 @@ SO_ESCR        define 2
 SO_CRIA_PROC   define 7
 SO_MATA_PROC   define 8
 SO_ESPERA_PROC define 9
+SO_ESCR_STR    define 12
 
 main
          chama impr_inicio
@@ -65,15 +66,26 @@ cada     valor CADA
 ene      valor N
 
 ; imprime a string que inicia em A (destroi X)
+; conta os caracteres e chama o SO uma vez só, para a string toda
 impstr   espaco 1
+         armm is_end
          trax
 impstr1
          cargx 0
          desvz impstrf
-         chama impch
          incx
          desv impstr1
-impstrf  ret impstr
+impstrf  cpxa
+         sub is_end
+         armm is_tam
+         cargi is_end
+         trax
+         cargi SO_ESCR_STR
+         chamas
+         ret impstr
+; argumentos de SO_ESCR_STR: endereço e número de caracteres
+is_end   espaco 1
+is_tam   espaco 1
 
 ; função que chama o SO para imprimir o caractere em A
 ; retorna em A o código de erro do SO
@@ -90,16 +102,22 @@ impch    espaco 1
 impch_X  espaco 1 ; para salvar o valor de X
 
 ; escreve o valor de A no terminal, em decimal
+; os caracteres são juntados em ei_buf, e escritos com uma chamada ao SO
+; não altera o valor de X
 impnum  espaco 1
         ; ei_num = A
         armm ei_num
+        ; ei_n = 0
+        cargi 0
+        armm ei_n
+        cargm ei_num
         ; if ei_num > 0 goto ei_pos
         desvp ei_pos
         ; if ei_num < 0 goto ei_neg
         desvn ei_neg
         ; print '0'; goto ei_f
         cargi '0'
-        chama impch
+        chama ei_poe
         desv ei_f
 ei_neg
         ; ei_num = -ei_num
@@ -107,7 +125,7 @@ ei_neg
         armm ei_num
         ; print '-'
         cargi '-'
-        chama impch
+        chama ei_poe
 ei_pos
         ; faz ei_mul ser a maior potência de 10 <= ei_num
         ; ei_mul = 1
@@ -137,7 +155,7 @@ ei_3
         div ei_mul
         resto dez
         soma a_zero
-        chama impch
+        chama ei_poe
         ; ei_mul /= 10
         cargm ei_mul
         div dez
@@ -147,11 +165,42 @@ ei_3
 ei_f
         ; print ' '
         cargi ' '
-        chama impch
+        chama ei_poe
+        ; escreve ei_buf, salvando X
+        trax
+        armm ei_X
+        cargi ei_arg
+        trax
+        cargi SO_ESCR_STR
+        chamas
+        cargm ei_X
+        trax
         ; return
         ret impnum
+
+; põe o caractere em A no fim de ei_buf (não altera o valor de X)
+ei_poe  espaco 1
+        armm ei_car
+        trax
+        armm ei_X
+        cargm ei_n
+        trax
+        cargm ei_car
+        armx ei_buf
+        incx
+        cpxa
+        armm ei_n
+        cargm ei_X
+        trax
+        ret ei_poe
 ei_num  espaco 1
 ei_mul  espaco 1
 a_zero  valor '0'
 dez     valor 10
+ei_car  espaco 1
+ei_X    espaco 1
+ei_buf  espaco 12
+; argumentos de SO_ESCR_STR: endereço e número de caracteres de ei_buf
+ei_arg  valor ei_buf
+ei_n    espaco 1
 
@@ -31,4 +31,8 @@ int prog_end_inicio(programa_t *self);
 // valor a colocar na posição 'ender' da memória
 int prog_dado(programa_t *self, int ender);
 
+// vetor com os prog_tamanho() valores do programa, o primeiro correspondendo
+//   ao endereço de carga (para copiar o programa em blocos)
+int *prog_dados(programa_t *self);
+
 #endif // PROGRAMA_H
@@ -0,0 +1,420 @@
+// quadros.c
+// tabela de quadros da memória principal
+// simulador de computador
+// so24b
+
+#include "quadros.h"
+
+#include <stdlib.h>
+#include <assert.h>
+
+tabquadros_t *tabquadros_cria(int n_quadros, int primeiro)
+{
+  tabquadros_t *self = malloc(sizeof(*self));
+  assert(self != NULL);
+  self->quadros = calloc(n_quadros, sizeof(quadro_t));
+  assert(self->quadros != NULL);
+  self->n_quadros = n_quadros;
+  self->primeiro = primeiro;
+  self->n_livres = n_quadros - primeiro;
+  self->ponteiro = primeiro;
+  self->n_guardas = 0;
+  return self;
+}
+
+void tabquadros_destroi(tabquadros_t *self)
+{
+  if (self != NULL)
+  {
+    free(self->quadros);
+    free(self);
+  }
+}
+
+int tabquadros_livre(tabquadros_t *self)
+{
+  if (self->n_livres == 0)
+    return -1;
+  int guardado = -1;
+  int reservado = -1;
+  for (int quadro = self->primeiro; quadro < self->n_quadros; quadro++)
+  {
+    quadro_t *q = &self->quadros[quadro];
+    if (q->ocupado)
+      continue;
+    if (q->reserva_proc != NULL)
+    {
+      if (reservado == -1)
+        reservado = quadro;
+      continue;
+    }
+    if (!q->guardada)
+      return quadro;
+    if (guardado == -1 || q->ordem_guarda < self->quadros[guardado].ordem_guarda)
+      guardado = quadro;
+  }
+  return guardado != -1 ? guardado : reservado;
+}
+
+int tabquadros_reserva_grande(tabquadros_t *self, int n, processo_t *processo, int pagina)
+{
+  int inicio = (self->primeiro + n - 1) / n * n;
+  for (int bloco = inicio; bloco + n <= self->n_quadros; bloco += n)
+  {
+    int i;
+    for (i = 0; i < n; i++)
+    {
+      quadro_t *q = &self->quadros[bloco + i];
+      if (q->ocupado || q->reserva_proc != NULL)
+        break;
+    }
+    if (i < n)
+      continue;
+    for (i = 0; i < n; i++)
+    {
+      self->quadros[bloco + i].reserva_proc = processo;
+      self->quadros[bloco + i].reserva_pagina = pagina + i;
+    }
+    return bloco;
+  }
+  return -1;
+}
+
+int tabquadros_procura_reserva(tabquadros_t *self, processo_t *processo, int pagina)
+{
+  for (int quadro = self->primeiro; quadro < self->n_quadros; quadro++)
+  {
+    quadro_t *q = &self->quadros[quadro];
+    if (q->reserva_proc == processo && q->reserva_pagina == pagina)
+      return quadro;
+  }
+  return -1;
+}
+
+void tabquadros_desfaz_reserva(tabquadros_t *self, int quadro, int n)
+{
+  int bloco = quadro - quadro % n;
+  for (int i = 0; i < n && bloco + i < self->n_quadros; i++)
+  {
+    self->quadros[bloco + i].reserva_proc = NULL;
+  }
+}
+
+// o quadro tem uma página que pode ser usada pelos algoritmos
+static bool tabquadros__residente(quadro_t *q)
+{
+  return q->ocupado && !q->em_transito;
+}
+
+// retorna true se o quadro pode ser escolhido como vítima por uma
+//   substituição restrita ao processo (ou global, se ele for NULL)
+static bool tabquadros__candidato(quadro_t *q, processo_t *processo)
+{
+  return tabquadros__residente(q) && (processo == NULL || q->processo == processo);
+}
+
+int tabquadros_n_residentes(tabquadros_t *self, processo_t *processo)
+{
+  int n = 0;
+  for (int quadro = self->primeiro; quadro < self->n_quadros; quadro++)
+  {
+    if (tabquadros__candidato(&self->quadros[quadro], processo))
+      n++;
+  }
+  return n;
+}
+
+bool tabquadros_residente(tabquadros_t *self, int quadro)
+{
+  return tabquadros__residente(&self->quadros[quadro]);
+}
+
+// calcula os menores valores de contador e de acessos entre os quadros
+//   ocupados (do processo, se não for NULL), sem contar o quadro 'exceto'
+static void tabquadros__menores(tabquadros_t *self, int exceto, processo_t *processo,
+                                int *pcontador, int *pacessos)
+{
+  bool achou = false;
+  *pcontador = 0;
+  *pacessos = 0;
+  for (int quadro = self->primeiro; quadro < self->n_quadros; quadro++)
+  {
+    quadro_t *q = &self->quadros[quadro];
+    if (!tabquadros__candidato(q, processo) || quadro == exceto)
+      continue;
+    int acessos = q->base_acessos + tabpag_n_acessos(q->tabpag, q->pagina);
+    if (!achou || q->contador < *pcontador)
+      *pcontador = q->contador;
+    if (!achou || acessos < *pacessos)
+      *pacessos = acessos;
+    achou = true;
+  }
+}
+
+void tabquadros_ocupa(tabquadros_t *self, int quadro, processo_t *processo,
+                      tabpag_t *tabpag, int pagina, int agora, bool local)
+{
+  int menor_contador, menor_acessos;
+  tabquadros__menores(self, quadro, local ? processo : NULL, &menor_contador, &menor_acessos);
+  quadro_t *q = &self->quadros[quadro];
+  if (!q->ocupado)
+    self->n_livres--;
+  q->ocupado = true;
+  q->em_transito = false;
+  q->processo = processo;
+  q->tabpag = tabpag;
+  q->pagina = pagina;
+  q->ultimo_uso = agora;
+  // a página foi carregada porque ia ser acessada; conta como um acesso,
+  //   senão seria a primeira a sair
+  q->idade = 1u << 31;
+  q->contador = menor_contador + 1;
+  q->base_acessos = menor_acessos;
+  q->acessos_vistos = tabpag_n_acessos(tabpag, pagina);
+  q->antecipada = false;
+  q->guardada = false;
+  q->compartilhada = false;
+  q->do_programa = false;
+  q->mesclado = false;
+  q->resumido = false;
+  q->estavel = false;
+  q->n_refs = 1;
+}
+
+void tabquadros_reserva(tabquadros_t *self, int quadro, processo_t *processo,
+                        tabpag_t *tabpag, int pagina)
+{
+  quadro_t *q = &self->quadros[quadro];
+  if (!q->ocupado)
+    self->n_livres--;
+  q->ocupado = true;
+  q->em_transito = true;
+  q->guardada = false;
+  q->compartilhada = false;
+  q->do_programa = false;
+  q->mesclado = false;
+  q->resumido = false;
+  q->estavel = false;
+  q->n_refs = 0;
+  q->processo = processo;
+  q->tabpag = tabpag;
+  q->pagina = pagina;
+}
+
+void tabquadros_libera(tabquadros_t *self, int quadro)
+{
+  quadro_t *q = &self->quadros[quadro];
+  if (q->ocupado)
+    self->n_livres++;
+  q->ocupado = false;
+  q->em_transito = false;
+  q->guardada = false;
+  q->compartilhada = false;
+  q->do_programa = false;
+  q->mesclado = false;
+  q->resumido = false;
+  q->estavel = false;
+  q->n_refs = 0;
+  q->processo = NULL;
+  q->tabpag = NULL;
+}
+
+void tabquadros_guarda(tabquadros_t *self, int quadro)
+{
+  quadro_t *q = &self->quadros[quadro];
+  if (q->ocupado)
+    self->n_livres++;
+  q->ocupado = false;
+  q->em_transito = false;
+  q->guardada = true;
+  q->compartilhada = false;
+  q->do_programa = false;
+  q->mesclado = false;
+  q->resumido = false;
+  q->estavel = false;
+  q->n_refs = 0;
+  q->ordem_guarda = self->n_guardas++;
+}
+
+int tabquadros_procura_guardada(tabquadros_t *self, processo_t *processo, int pagina)
+{
+  for (int quadro = self->primeiro; quadro < self->n_quadros; quadro++)
+  {
+    quadro_t *q = &self->quadros[quadro];
+    if (q->guardada && q->processo == processo && q->pagina == pagina)
+      return quadro;
+  }
+  return -1;
+}
+
+quadro_t *tabquadros_quadro(tabquadros_t *self, int quadro)
+{
+  return &self->quadros[quadro];
+}
+
+void tabquadros_amostra(tabquadros_t *self)
+{
+  for (int quadro = self->primeiro; quadro < self->n_quadros; quadro++)
+  {
+    quadro_t *q = &self->quadros[quadro];
+    if (!tabquadros__residente(q))
+      continue;
+    bool acessada = tabpag_bit_acesso(q->tabpag, q->pagina);
+    q->idade >>= 1;
+    if (acessada)
+    {
+      q->idade |= 1u << 31;
+      q->contador++;
+      tabpag_zera_bit_acesso(q->tabpag, q->pagina);
+    }
+  }
+}
+
+bool tabquadros_foi_acessado(tabquadros_t *self, int quadro)
+{
+  quadro_t *q = &self->quadros[quadro];
+  if (!tabquadros__residente(q))
+    return false;
+  int acessos = tabpag_n_acessos(q->tabpag, q->pagina);
+  bool acessado = acessos != q->acessos_vistos;
+  q->acessos_vistos = acessos;
+  return acessado;
+}
+
+// avança o ponteiro do relógio, dando a volta no final do vetor
+static void tabquadros__avanca(tabquadros_t *self)
+{
+  self->ponteiro++;
+  if (self->ponteiro >= self->n_quadros)
+    self->ponteiro = self->primeiro;
+}
+
+int tabquadros_escolhe_clock(tabquadros_t *self, processo_t *processo)
+{
+  // na pior das hipóteses, dá uma volta zerando todos os bits e escolhe o
+  //   primeiro candidato da segunda volta; com o filtro por processo, o
+  //   ponteiro pode não começar em um quadro dele, por isso são duas voltas
+  int n_usuario = self->n_quadros - self->primeiro;
+  for (int n = 0; n < 2 * n_usuario; n++)
+  {
+    int quadro = self->ponteiro;
+    quadro_t *q = &self->quadros[quadro];
+    tabquadros__avanca(self);
+    if (!tabquadros__candidato(q, processo))
+      continue;
+    if (!tabpag_bit_acesso(q->tabpag, q->pagina))
+      return quadro;
+    tabpag_zera_bit_acesso(q->tabpag, q->pagina);
+  }
+  return -1;
+}
+
+int tabquadros_escolhe_wsclock(tabquadros_t *self, processo_t *processo, int agora, int tau)
+{
+  int n_usuario = self->n_quadros - self->primeiro;
+  int alterado_antigo = -1;
+  int mais_antigo = -1;
+  int primeiro = -1;
+  for (int n = 0; n < n_usuario; n++)
+  {
+    int quadro = self->ponteiro;
+    quadro_t *q = &self->quadros[quadro];
+    tabquadros__avanca(self);
+    if (!tabquadros__candidato(q, processo))
+      continue;
+    if (primeiro == -1)
+      primeiro = quadro;
+    if (tabpag_bit_acesso(q->tabpag, q->pagina))
+    {
+      // usada desde a última passagem do ponteiro: está no conjunto de trabalho
+      tabpag_zera_bit_acesso(q->tabpag, q->pagina);
+      q->ultimo_uso = agora;
+      continue;
+    }
+    if (agora - q->ultimo_uso > tau)
+    {
+      if (!tabpag_bit_alteracao(q->tabpag, q->pagina))
+        return quadro;
+      if (alterado_antigo == -1)
+        alterado_antigo = quadro;
+    }
+    if (mais_antigo == -1 || q->ultimo_uso < self->quadros[mais_antigo].ultimo_uso)
+      mais_antigo = quadro;
+  }
+  int escolhido = alterado_antigo != -1 ? alterado_antigo : mais_antigo;
+  if (escolhido == -1)
+  {
+    // todas as páginas estavam sendo usadas; fica com a primeira que o
+    //   ponteiro encontrou
+    if (primeiro == -1)
+      return -1;
+    escolhido = primeiro;
+  }
+  self->ponteiro = escolhido;
+  tabquadros__avanca(self);
+  return escolhido;
+}
+
+// tipo das funções que dão o valor de um quadro para os algoritmos baseados
+//   em contadores; a vítima é o quadro de menor valor
+typedef unsigned int (*f_valor_t)(quadro_t *q);
+
+static unsigned int valor_idade(quadro_t *q)
+{
+  return q->idade;
+}
+
+static unsigned int valor_contador(quadro_t *q)
+{
+  return q->contador;
+}
+
+static unsigned int valor_acessos(quadro_t *q)
+{
+  return q->base_acessos + tabpag_n_acessos(q->tabpag, q->pagina);
+}
+
+// escolhe o quadro ocupado de menor valor; a busca começa no ponteiro e o
+//   ponteiro passa para depois do escolhido, para que os empates não
+//   escolham sempre os mesmos quadros
+static int tabquadros__escolhe_menor(tabquadros_t *self, processo_t *processo, f_valor_t valor)
+{
+  int n_usuario = self->n_quadros - self->primeiro;
+  int escolhido = -1;
+  unsigned int menor = 0;
+  for (int n = 0; n < n_usuario; n++)
+  {
+    int quadro = self->ponteiro;
+    quadro_t *q = &self->quadros[quadro];
+    tabquadros__avanca(self);
+    if (!tabquadros__candidato(q, processo))
+      continue;
+    unsigned int v = valor(q);
+    if (escolhido == -1 || v < menor)
+    {
+      escolhido = quadro;
+      menor = v;
+    }
+  }
+  if (escolhido != -1)
+  {
+    self->ponteiro = escolhido;
+    tabquadros__avanca(self);
+  }
+  return escolhido;
+}
+
+int tabquadros_escolhe_envelhecimento(tabquadros_t *self, processo_t *processo)
+{
+  return tabquadros__escolhe_menor(self, processo, valor_idade);
+}
+
+int tabquadros_escolhe_nfu(tabquadros_t *self, processo_t *processo)
+{
+  return tabquadros__escolhe_menor(self, processo, valor_contador);
+}
+
+int tabquadros_escolhe_lfu(tabquadros_t *self, processo_t *processo)
+{
+  return tabquadros__escolhe_menor(self, processo, valor_acessos);
+}
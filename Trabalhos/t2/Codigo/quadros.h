@@ -0,0 +1,213 @@
+// quadros.h
+// tabela de quadros da memória principal
+// simulador de computador
+// so24b
+
+#ifndef QUADROS_H
+#define QUADROS_H
+
+// mantém, para cada quadro da memória principal, se está livre ou qual página
+//   de qual processo ele contém
+// implementa a escolha de vítima pelos algoritmos do relógio (CLOCK e WSClock),
+//   com um ponteiro que percorre circularmente o vetor de quadros, sem alocar
+//   memória na substituição, e pelos algoritmos baseados em contadores
+//   (envelhecimento, NFU e LFU)
+// os bits de acesso e alteração são os da tabela de páginas do processo dono
+//   do quadro
+// um quadro pode estar em trânsito: reservado enquanto o disco grava a página
+//   que saiu dele ou lê a que vai entrar; quadros em trânsito não são
+//   escolhidos como vítima nem amostrados
+// um quadro pode estar compartilhado entre processos: é mapeado somente
+//   para leitura na tabela de páginas de cada um deles, e conta quantas
+//   tabelas o mapeiam; o processo e a tabela do quadro são os de um deles
+//   (o dono), e os bits de acesso usados pelos algoritmos são os dele
+// são compartilhadas as páginas do programa que ainda não foram alteradas,
+//   entre os processos que executam o mesmo programa, e as páginas de um
+//   processo e de seus filhos criados por SO_FORK, até que um deles escreva;
+//   o SO também pode juntar em um quadro compartilhado páginas iguais de
+//   processos quaisquer (quadro mesclado)
+// um quadro livre pode continuar guardando a página que estava nele, se ela
+//   é igual à da memória secundária; se a página for necessária antes de o
+//   quadro ser usado por outra, ela volta sem ser lida do disco. Os quadros
+//   livres sem página guardada são usados primeiro.
+// um bloco alinhado de quadros pode ser reservado para as páginas de uma
+//   página grande de um processo (ver tabpag.h): cada quadro do bloco fica
+//   reservado para uma das páginas, que pode ir para ele quando faltar; a
+//   reserva não muda se o quadro está livre ou ocupado, e só deixa de
+//   existir quando é desfeita. Os quadros livres não reservados são usados
+//   primeiro.
+
+#include "tabpag.h"
+#include <stdbool.h>
+
+typedef struct processo_t processo_t;
+
+typedef struct
+{
+  // o quadro contém uma página
+  bool ocupado;
+  // o quadro está reservado para uma transferência com o disco
+  bool em_transito;
+  // processo dono da página, e sua tabela de páginas
+  processo_t *processo;
+  tabpag_t *tabpag;
+  // número da página no espaço de endereçamento do processo
+  int pagina;
+  // último instante em que a página foi vista sendo usada (para o WSClock)
+  int ultimo_uso;
+  // registrador de deslocamento do envelhecimento: a cada amostragem é
+  //   deslocado para a direita e recebe o bit de acesso no bit mais alto
+  unsigned int idade;
+  // número de amostragens em que a página estava acessada (para o NFU)
+  int contador;
+  // valor somado aos acessos contados pela MMU (para o LFU)
+  int base_acessos;
+  // acessos contados pela MMU na última consulta de tabquadros_foi_acessado
+  int acessos_vistos;
+  // a página foi trazida por leitura antecipada e ainda não foi vista em uso
+  bool antecipada;
+  // o quadro está compartilhado (mapeado somente para leitura), e o número
+  //   de tabelas de páginas que mapeiam o quadro
+  bool compartilhada;
+  int n_refs;
+  // a página é igual à do programa, e pode ser mapeada por outros processos
+  //   que executam a mesma imagem
+  bool do_programa;
+  // o quadro recebeu páginas iguais que estavam em outros quadros
+  bool mesclado;
+  // resumo do conteúdo do quadro calculado pelo SO para encontrar páginas
+  //   iguais, e se o conteúdo não mudou entre os dois últimos cálculos
+  bool resumido;
+  unsigned int resumo;
+  bool estavel;
+  // o quadro está livre, mas ainda guarda a página (processo, tabpag e
+  //   pagina), e em que ordem as páginas foram guardadas
+  bool guardada;
+  int ordem_guarda;
+  // processo e página para os quais o quadro está reservado (processo NULL
+  //   se o quadro não está reservado)
+  processo_t *reserva_proc;
+  int reserva_pagina;
+} quadro_t;
+
+typedef struct
+{
+  // número total de quadros da memória
+  int n_quadros;
+  // primeiro quadro que pode ser usado por processos (os anteriores são do SO)
+  int primeiro;
+  // número de quadros livres
+  int n_livres;
+  // posição do ponteiro do relógio
+  int ponteiro;
+  // número de páginas já guardadas em quadros livres
+  int n_guardas;
+  // vetor com os quadros
+  quadro_t *quadros;
+} tabquadros_t;
+
+// cria uma tabela para 'n_quadros' quadros; os quadros a partir de 'primeiro'
+//   estão livres, os anteriores nunca são usados
+// mata o programa em caso de erro (malloc)
+tabquadros_t *tabquadros_cria(int n_quadros, int primeiro);
+
+// destrói a tabela
+void tabquadros_destroi(tabquadros_t *self);
+
+// retorna o número de um quadro livre, ou -1 se não houver
+// se todos os quadros livres guardam páginas, retorna o que guarda há mais
+//   tempo; a página guardada é perdida quando o quadro é ocupado ou reservado
+// um quadro reservado para uma página grande só é retornado se todos os
+//   quadros livres estão reservados
+int tabquadros_livre(tabquadros_t *self);
+
+// reserva um bloco de 'n' quadros livres e não reservados, a partir de um
+//   quadro múltiplo de 'n', para as páginas do processo a partir de
+//   'pagina'; as páginas guardadas nos quadros do bloco são perdidas quando
+//   forem ocupados
+// retorna o primeiro quadro do bloco, ou -1 se não houver bloco livre
+int tabquadros_reserva_grande(tabquadros_t *self, int n, processo_t *processo, int pagina);
+
+// retorna o quadro reservado para a página 'pagina' do processo, ou -1
+int tabquadros_procura_reserva(tabquadros_t *self, processo_t *processo, int pagina);
+
+// desfaz a reserva do bloco de 'n' quadros que contém o quadro 'quadro'
+void tabquadros_desfaz_reserva(tabquadros_t *self, int quadro, int n);
+
+// registra que o quadro 'quadro' passou a conter a página 'pagina' do processo
+// os contadores do NFU e LFU da página começam com o menor valor entre as
+//   páginas residentes; se começassem em 0 a página nova seria sempre a
+//   próxima vítima, e uma instrução que precisa de duas páginas ausentes
+//   nunca conseguiria ter as duas na memória ao mesmo tempo
+// se 'local' for true, o processo está sujeito à substituição local, e o
+//   menor valor é o das páginas dele
+void tabquadros_ocupa(tabquadros_t *self, int quadro, processo_t *processo,
+                      tabpag_t *tabpag, int pagina, int agora, bool local);
+
+// registra que o quadro 'quadro' está em trânsito, reservado para a página
+//   'pagina' do processo (ou com a página do processo sendo gravada)
+// o quadro deixa de estar em trânsito com tabquadros_ocupa ou tabquadros_libera
+void tabquadros_reserva(tabquadros_t *self, int quadro, processo_t *processo,
+                        tabpag_t *tabpag, int pagina);
+
+// registra que o quadro 'quadro' está livre
+void tabquadros_libera(tabquadros_t *self, int quadro);
+
+// registra que o quadro 'quadro' está livre, mas continua guardando a página
+//   que estava nele
+void tabquadros_guarda(tabquadros_t *self, int quadro);
+
+// retorna o quadro livre que guarda a página 'pagina' do processo, ou -1
+int tabquadros_procura_guardada(tabquadros_t *self, processo_t *processo, int pagina);
+
+// retorna true se o quadro contém uma página que não está em trânsito
+bool tabquadros_residente(tabquadros_t *self, int quadro);
+
+// número de quadros com páginas do processo que não estão em trânsito
+//   (conjunto residente); um quadro compartilhado conta só para o dono
+int tabquadros_n_residentes(tabquadros_t *self, processo_t *processo);
+
+// retorna o descritor do quadro 'quadro'
+quadro_t *tabquadros_quadro(tabquadros_t *self, int quadro);
+
+// as funções de escolha de vítima consideram só os quadros do processo
+//   'processo' (substituição local), ou todos se ele for NULL
+
+// escolhe um quadro ocupado para ser substituído, pelo algoritmo do relógio:
+//   o ponteiro avança zerando os bits de acesso até encontrar uma página
+//   com bit de acesso zerado
+int tabquadros_escolhe_clock(tabquadros_t *self, processo_t *processo);
+
+// escolhe um quadro ocupado para ser substituído, pelo algoritmo WSClock:
+//   páginas acessadas têm o bit de acesso zerado e o último uso atualizado
+//   para 'agora'; é escolhida a primeira página não alterada que está fora
+//   do conjunto de trabalho (não usada há mais de 'tau'). Se não houver,
+//   escolhe a primeira alterada fora do conjunto de trabalho ou, em último
+//   caso, a usada há mais tempo. Faz no máximo uma volta completa.
+int tabquadros_escolhe_wsclock(tabquadros_t *self, processo_t *processo, int agora, int tau);
+
+// amostra os bits de acesso de todos os quadros ocupados, para os algoritmos
+//   baseados em contadores: atualiza a idade e o contador de cada quadro e
+//   zera o bit de acesso
+// deve ser chamada periodicamente (a cada interrupção do relógio)
+void tabquadros_amostra(tabquadros_t *self);
+
+// retorna true se a página do quadro foi acessada desde a consulta anterior
+//   (ou desde que foi carregada); usa o contador de acessos da MMU, e não
+//   altera o bit de acesso usado pelos algoritmos de substituição
+bool tabquadros_foi_acessado(tabquadros_t *self, int quadro);
+
+// escolhe um quadro ocupado para ser substituído, pelo algoritmo do
+//   envelhecimento (aproximação do LRU): o de menor idade
+int tabquadros_escolhe_envelhecimento(tabquadros_t *self, processo_t *processo);
+
+// escolhe um quadro ocupado para ser substituído, pelo algoritmo NFU (não
+//   usada frequentemente): o que estava acessado em menos amostragens
+int tabquadros_escolhe_nfu(tabquadros_t *self, processo_t *processo);
+
+// escolhe um quadro ocupado para ser substituído, pelo algoritmo LFU (menos
+//   frequentemente usada): o com menos acessos contados pela MMU desde que
+//   a página foi carregada
+int tabquadros_escolhe_lfu(tabquadros_t *self, processo_t *processo);
+
+#endif // QUADROS_H
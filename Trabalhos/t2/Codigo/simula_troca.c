@@ -0,0 +1,270 @@
+// simula_troca.c
+// simulador de algoritmos de substituição de páginas sobre um rastro
+// simulador de computador
+// so24b
+
+// lê um rastro de referências a páginas gerado pelo simulador (main -r arquivo)
+//   e conta as faltas de página de vários algoritmos de substituição para uma
+//   faixa de números de quadros, sem precisar executar de novo a simulação
+// os quadros são compartilhados por todos os processos (substituição global),
+//   como no SO
+
+// INCLUDES {{{1
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+// AUXILIARES {{{1
+// aborta o programa com uma mensagem de erro
+void erro_brabo(char *msg)
+{
+  fprintf(stderr, "ERRO FATAL: %s\n", msg);
+  exit(1);
+}
+
+void *aloca(int n, int tam)
+{
+  void *p = calloc(n, tam);
+  if (p == NULL) erro_brabo("sem memória");
+  return p;
+}
+
+// RASTRO {{{1
+
+// referências lidas do rastro; cada página de cada processo é identificada
+//   por um número entre 0 e n_pags-1
+int n_refs;
+int *refs;
+int n_pags;
+// para cada referência, a posição da próxima referência à mesma página
+//   (n_refs se não houver), usado pelo algoritmo ótimo
+int *prox;
+
+void le_rastro(char *nome)
+{
+  FILE *arq = fopen(nome, "r");
+  if (arq == NULL) {
+    perror(nome);
+    exit(1);
+  }
+  // primeira passada: conta as referências e acha os maiores pid e página
+  int pid, pag;
+  char op;
+  int max_pid = 0, max_pag = 0;
+  n_refs = 0;
+  while (fscanf(arq, "%d %d %c", &pid, &pag, &op) == 3) {
+    if (pid < 0 || pag < 0) erro_brabo("rastro inválido");
+    if (pid > max_pid) max_pid = pid;
+    if (pag > max_pag) max_pag = pag;
+    n_refs++;
+  }
+  // segunda passada: numera as páginas na ordem em que aparecem
+  int *id = aloca((max_pid + 1) * (max_pag + 1), sizeof(int));
+  for (int i = 0; i < (max_pid + 1) * (max_pag + 1); i++) id[i] = -1;
+  refs = aloca(n_refs, sizeof(int));
+  rewind(arq);
+  n_pags = 0;
+  for (int i = 0; i < n_refs; i++) {
+    if (fscanf(arq, "%d %d %c", &pid, &pag, &op) != 3) erro_brabo("erro relendo o rastro");
+    int chave = pid * (max_pag + 1) + pag;
+    if (id[chave] == -1) id[chave] = n_pags++;
+    refs[i] = id[chave];
+  }
+  fclose(arq);
+  free(id);
+
+  // calcula a próxima referência de cada página, de trás para frente
+  prox = aloca(n_refs, sizeof(int));
+  int *ultima = aloca(n_pags, sizeof(int));
+  for (int p = 0; p < n_pags; p++) ultima[p] = n_refs;
+  for (int i = n_refs - 1; i >= 0; i--) {
+    prox[i] = ultima[refs[i]];
+    ultima[refs[i]] = i;
+  }
+  free(ultima);
+}
+
+// SIMULAÇÃO {{{1
+
+// estado dos quadros durante uma simulação
+int n_quadros;
+int n_ocupados;
+int *quadro_da_pag;   // quadro onde está cada página, ou -1
+int *pag_do_quadro;   // página em cada quadro
+int *info;            // informação de cada quadro, depende do algoritmo
+
+// tipo das funções que implementam um algoritmo
+// 'vitima' é chamada quando não tem quadro livre, e retorna o quadro a liberar
+// 'referencia' é chamada a cada referência 'i' à página que está no quadro 'q'
+//   (depois da carga, se houve falta)
+typedef struct {
+  char *nome;
+  int (*vitima)(int i);
+  void (*referencia)(int i, int q);
+} algoritmo_t;
+
+// retorna o número de faltas de página do algoritmo com 'n' quadros
+int simula(algoritmo_t *alg, int n)
+{
+  n_quadros = n;
+  n_ocupados = 0;
+  for (int p = 0; p < n_pags; p++) quadro_da_pag[p] = -1;
+  for (int q = 0; q < n; q++) info[q] = 0;
+  int faltas = 0;
+  for (int i = 0; i < n_refs; i++) {
+    int pag = refs[i];
+    int q = quadro_da_pag[pag];
+    if (q == -1) {
+      faltas++;
+      if (n_ocupados < n_quadros) {
+        q = n_ocupados++;
+      } else {
+        q = alg->vitima(i);
+        quadro_da_pag[pag_do_quadro[q]] = -1;
+      }
+      quadro_da_pag[pag] = q;
+      pag_do_quadro[q] = pag;
+      info[q] = 0;
+    }
+    alg->referencia(i, q);
+  }
+  return faltas;
+}
+
+// FIFO e CLOCK usam um ponteiro que percorre os quadros em ordem (com os
+//   quadros sendo substituídos no lugar, a ordem de carga é a ordem dos quadros)
+// info[q] é o bit de acesso (CLOCK)
+// a segunda chance do SO (fila de páginas em que a primeira sai se não foi
+//   acessada, senão vai para o fim da fila com o bit zerado) não tem coluna
+//   própria: aqui as páginas entram na fila quando faltam e só saem como
+//   vítimas, e então ela escolhe sempre as mesmas vítimas que o CLOCK (a
+//   fila, lida a partir do início, é o vetor de quadros lido a partir do
+//   ponteiro). No SO elas podem diferir, porque as páginas entram na fila
+//   quando a leitura do disco termina e saem quando o processo morre.
+int ponteiro;
+
+void nada(int i, int q)
+{
+}
+
+int fifo_vitima(int i)
+{
+  int q = ponteiro;
+  ponteiro = (ponteiro + 1) % n_quadros;
+  return q;
+}
+
+void marca_acesso(int i, int q)
+{
+  info[q] = 1;
+}
+
+int clock_vitima(int i)
+{
+  while (info[ponteiro] != 0) {
+    info[ponteiro] = 0;
+    ponteiro = (ponteiro + 1) % n_quadros;
+  }
+  int q = ponteiro;
+  ponteiro = (ponteiro + 1) % n_quadros;
+  return q;
+}
+
+// LRU: info[q] é a posição da última referência à página do quadro
+int lru_vitima(int i)
+{
+  int vitima = 0;
+  for (int q = 1; q < n_quadros; q++) {
+    if (info[q] < info[vitima]) vitima = q;
+  }
+  return vitima;
+}
+
+void lru_referencia(int i, int q)
+{
+  info[q] = i;
+}
+
+// OTIMO (Belady): info[q] é a posição da próxima referência à página do quadro;
+//   a vítima é a que vai ser usada mais tarde
+int otimo_vitima(int i)
+{
+  int vitima = 0;
+  for (int q = 1; q < n_quadros; q++) {
+    if (info[q] > info[vitima]) vitima = q;
+  }
+  return vitima;
+}
+
+void otimo_referencia(int i, int q)
+{
+  info[q] = prox[i];
+}
+
+algoritmo_t algoritmos[] = {
+  { "FIFO",     fifo_vitima,           nada             },
+  { "CLOCK",    clock_vitima,          marca_acesso     },
+  { "LRU",      lru_vitima,            lru_referencia   },
+  { "OTIMO",    otimo_vitima,          otimo_referencia },
+};
+#define N_ALGORITMOS (sizeof(algoritmos) / sizeof(algoritmos[0]))
+
+void simula_todos(int n)
+{
+  printf("%8d", n);
+  for (int a = 0; a < N_ALGORITMOS; a++) {
+    ponteiro = 0;
+    printf(" %9d", simula(&algoritmos[a], n));
+  }
+  printf("\n");
+}
+
+// PRINCIPAL {{{1
+
+void verifica_args(int argc, char *argv[argc], int *min, int *max, int *passo)
+{
+  if (argc != 2 && argc != 4 && argc != 5) {
+    fprintf(stderr, "Uso: %s rastro [min max [passo]]\n", argv[0]);
+    fprintf(stderr, "  simula a substituição de páginas com min a max quadros\n");
+    exit(1);
+  }
+  *min = 1;
+  *max = 0;
+  *passo = 1;
+  if (argc >= 4) {
+    *min = atoi(argv[2]);
+    *max = atoi(argv[3]);
+  }
+  if (argc == 5) *passo = atoi(argv[4]);
+  if (*min < 1 || *passo < 1) erro_brabo("número de quadros inválido");
+}
+
+int main(int argc, char *argv[argc])
+{
+  int min, max, passo;
+  verifica_args(argc, argv, &min, &max, &passo);
+  le_rastro(argv[1]);
+  // sem faixa definida, vai até ter quadro para todas as páginas
+  if (max == 0) {
+    max = n_pags;
+    passo = (max - min) / 20 + 1;
+  }
+
+  quadro_da_pag = aloca(n_pags, sizeof(int));
+  pag_do_quadro = aloca(max, sizeof(int));
+  info = aloca(max, sizeof(int));
+
+  printf("rastro: %d referências a %d páginas diferentes\n", n_refs, n_pags);
+  printf("faltas de página por algoritmo:\n");
+  printf("%8s", "QUADROS");
+  for (int a = 0; a < N_ALGORITMOS; a++) {
+    printf(" %9s", algoritmos[a].nome);
+  }
+  printf("\n");
+  for (int n = min; n <= max; n += passo) {
+    simula_todos(n);
+  }
+  return 0;
+}
+
+// vim: foldmethod=marker
@@ -10,23 +10,82 @@
 #include "programa.h"
 #include "tabpag.h"
 #include "fifo.h"
+#include "swap.h"
+#include "quadros.h"
+#include "instantaneo.h"
+#include "disco.h"
 
 #include <stdlib.h>
 #include <stdbool.h>
 #include <assert.h>
 #include <stdio.h>
+#include <strings.h>
+#include <time.h>
+#include <limits.h>
 
 // CONSTANTES E TIPOS {{{1
 // intervalo entre interrupções do relógio
 #define INTERVALO_INTERRUPCAO 50
 #define QUANTUM 5
 #define ESCALONADOR 2 // 0 para prioridade, 1 para round-robin, 2 para simples
-#define TEMPO_DISCO 5
+// escalonamento dos pedidos ao disco (ver fila_disco.h)
+#define ESCALONADOR_DISCO ESC_DISCO_SSTF
 
-#define N_QUADROS 100
-
-#define TROCA_FIFO 0
-#define TROCA_SEGUNDA_CHANCE 1
+// algoritmos de substituição de páginas (ver so_define_troca)
+enum
+{
+  TROCA_FIFO,
+  TROCA_SEGUNDA_CHANCE,
+  TROCA_CLOCK,
+  TROCA_WSCLOCK,
+  TROCA_ENVELHECIMENTO,
+  TROCA_NFU,
+  TROCA_LFU,
+  N_TROCA
+};
+// algoritmo usado se não for escolhido outro
+#define ALGORITMO_TROCA TROCA_SEGUNDA_CHANCE
+// idade (em instruções) a partir da qual uma página não usada sai do
+//   conjunto de trabalho, no WSClock
+#define WSCLOCK_TAU 250
+
+// controle de carga
+// instruções em que uma página continua no conjunto de trabalho depois de usada
+#define JANELA_CONJ_TRABALHO 500
+// interrupções do relógio em cada janela de medição da taxa de faltas de
+//   página (PFF); o escalonador de médio prazo decide no fim de cada janela
+#define TIQUES_JANELA 10
+// liga o escalonador de médio prazo, que suspende processos quando a soma
+//   dos conjuntos de trabalho não cabe na memória principal
+#define CONTROLE_CARGA true
+
+// leitura antecipada: número máximo de páginas lidas além da que faltou
+#define MAX_ANTECIPACAO 8
+
+// daemon de paginação: quando os quadros livres ficam abaixo de LIVRES_MIN,
+//   libera quadros até ter LIVRES_ALVO
+#define DAEMON_PAGINAS true
+#define LIVRES_MIN 2
+#define LIVRES_ALVO 3
+
+// reserva de páginas comprimidas (ver zswap.h): número de quadros da
+//   memória principal usados por ela (0 para não usar); as páginas gravadas
+//   vão para a reserva enquanto couberem, e só as outras vão para o disco
+#define QUADROS_ZSWAP 3
+
+// mesclagem de páginas iguais: número de quadros examinados a cada
+//   interrupção do relógio
+#define MESCLA_PAGINAS true
+#define MESCLA_POR_TIQUE 8
+
+// limites do conjunto residente (quadros com páginas do processo) dos
+//   processos criados pelo SO; os processos criados por outros herdam os
+//   limites do criador, e podem mudá-los com SO_LIMITA_MEM (0 é sem limite)
+#define LIMITE_SUAVE 0
+#define LIMITE_RIGIDO 0
+// menor limite rígido aceito: uma instrução pode precisar de três páginas
+//   (duas com a instrução e uma com o dado)
+#define LIMITE_RIGIDO_MIN 3
 
 // função de tratamento de interrupção (entrada no SO)
 static int so_trata_interrupcao(void *argC, int reg_A);
@@ -37,73 +96,26 @@ static int so_trata_interrupcao(void *argC, int reg_A);
 static int so_carrega_programa(so_t *self, processo_t *processo, char *nome_do_executavel);
 // copia para str da memória do processo, até copiar um 0 (retorna true) ou tam bytes
 static bool so_copia_str_do_processo(so_t *self, int tam, char str[tam], int end_virt, processo_t *processo);
+static err_t so_le_do_processo(so_t *self, int end_virt, int *pvalor, processo_t *processo);
+static err_t so_escreve_no_processo(so_t *self, int end_virt, int valor, processo_t *processo);
 
 // funções auxiliares para cada chamada de sistema
 static void so_chamada_le(so_t *self);
 static void so_chamada_escr(so_t *self);
+static void so_chamada_escr_str(so_t *self);
+static void so_chamada_le_linha(so_t *self);
 static void so_chamada_cria_proc(so_t *self);
 static void so_chamada_mata_proc(so_t *self);
 static void so_chamada_espera_proc(so_t *self);
+static void so_chamada_fork(so_t *self);
+static void so_chamada_limita_mem(so_t *self);
 
-static void escreve_memoria_fisica(so_t *self)
-{
-  FILE *file = fopen("memoria_fisica.txt", "w");
-  if (!file)
-  {
-    perror("Erro ao abrir arquivo memoria_fisica.txt");
-    return;
-  }
-
-  fprintf(file, "Memória Física:\n");
-  for (int i = 0; i < N_QUADROS * TAM_PAGINA; i++)
-  {
-    int dado;
-    if (mem_le(self->mem, i, &dado) == ERR_OK)
-    {
-      if (i % 10 == 0)
-      {
-        fprintf(file, "\n------------- QUADRO RAM i: %d --------------\n", i / 10);
-      }
-      fprintf(file, "Endereço %d: %d\n", i, dado);
-    }
-    else
-    {
-      fprintf(file, "Endereço %d: erro de leitura\n", i);
-    }
-  }
-
-  fclose(file);
-}
-
-static void escreve_memoria_secundaria(so_t *self)
-{
-  FILE *file = fopen("memoria_secundaria.txt", "w");
-  if (!file)
-  {
-    perror("Erro ao abrir arquivo memoria_secundaria.txt");
-    return;
-  }
-
-  fprintf(file, "Memória Secundária:\n");
-  for (int i = 0; i < N_QUADROS * TAM_PAGINA; i++)
-  {
-    int dado;
-    if (mem_le(self->mem_secundaria, i, &dado) == ERR_OK)
-    {
-      if (i % 10 == 0)
-      {
-        fprintf(file, "\n------------- QUADRO DISCO i: %d --------------\n", i);
-      }
-      fprintf(file, "Endereço %d: %d\n", i, dado);
-    }
-    else
-    {
-      fprintf(file, "Endereço %d: erro de leitura\n", i);
-    }
-  }
-
-  fclose(file);
-}
+static char *so_nome_troca(so_t *self);
+static void remove_processo_da_lista(so_t *self, int pid);
+static void so_esvazia_tela(so_t *self, int terminal);
+static void so_enche_teclado(so_t *self, int terminal);
+static bool so_linha_pronta(buf_tela_t *buf, int falta);
+static bool so_ha_quadro_em_transito(so_t *self);
 
 // --- TEMPO ---
 int tempo_atual(so_t *self)
@@ -132,12 +144,30 @@ char *pega_nome_estado(estado_processo_t estado)
     return "BLOQUEADO";
   case ESTADO_MORTO:
     return "MORTO";
+  case ESTADO_SUSPENSO:
+    return "SUSPENSO";
   default:
     return "NÃO TRATADO";
   }
 }
 
 // funçoes para impressao e calculo das metricas
+
+static void so_imprime_cabecalho_histogramas(char *titulo)
+{
+  console_printf("| %-24s | N      | P50      | P95      | P99      | MÁXIMO   |\n", titulo);
+  console_printf("|--------------------------|--------|----------|----------|----------|----------|\n");
+}
+
+// 'nome' já vem completado com espaços até 24 colunas (os caracteres
+//   acentuados ocupam mais de um byte)
+static void so_imprime_histograma(char *nome, histograma_t *h)
+{
+  console_printf("| %s | %-6d | %-8d | %-8d | %-8d | %-8d |\n", nome, h->n,
+                 histograma_percentil(h, 50), histograma_percentil(h, 95),
+                 histograma_percentil(h, 99), h->max);
+}
+
 static void so_imprime_metricas(so_t *self)
 {
   console_printf("MÉTRICAS DO SO (quantum: %d, intervalo: %d):\n ", QUANTUM, INTERVALO_INTERRUPCAO);
@@ -147,6 +177,117 @@ static void so_imprime_metricas(so_t *self)
   console_printf("| TEMPO TOTAL DE EXECUÇÃO   | %-10d |\n", self->metricas.tempo_total_execucao);
   console_printf("| TEMPO TOTAL OCIOSO        | %-10d |\n", self->metricas.tempo_total_ocioso);
   console_printf("| NÚMERO DE PREEMPÇÕES      | %-10d |\n", self->metricas.num_preempcoes);
+  int total_page_faults = 0;
+  for (int i = 0; i < self->n_procs; i++)
+  {
+    total_page_faults += self->processos[i]->metricas.qtd_page_fault;
+  }
+  console_printf("| PAGE FAULTS (TOTAL)       | %-10d |\n", total_page_faults);
+  console_printf("| SUSPENSÕES                | %-10d |\n", self->metricas.num_suspensoes);
+  console_printf("| RETOMADAS                 | %-10d |\n", self->metricas.num_retomadas);
+  console_printf("| LEITURAS DO DISCO         | %-10d |\n", self->metricas.num_leituras_disco);
+  console_printf("| GRAVAÇÕES NO DISCO        | %-10d |\n", self->metricas.num_gravacoes_disco);
+  console_printf("| PEDIDOS CANCELADOS        | %-10d |\n", self->metricas.num_cancelamentos_disco);
+  console_printf("| PÁGINAS ANTECIPADAS       | %-10d |\n", self->metricas.num_antecipadas);
+  console_printf("| ANTECIPADAS USADAS        | %-10d |\n", self->metricas.num_antecipadas_usadas);
+  console_printf("| ANTECIPADAS PERDIDAS      | %-10d |\n", self->metricas.num_antecipadas_perdidas);
+  console_printf("| LIBERADOS PELO DAEMON     | %-10d |\n", self->metricas.num_liberados_daemon);
+  console_printf("| GRAVADOS PELO DAEMON      | %-10d |\n", self->metricas.num_limpezas_daemon);
+  console_printf("| FALTAS COM GRAVAÇÃO       | %-10d |\n", self->metricas.num_faltas_com_gravacao);
+  console_printf("| PÁGINAS RESGATADAS        | %-10d |\n", self->metricas.num_resgates);
+  console_printf("| PÁGINAS DO PROGRAMA       | %-10d |\n", self->metricas.num_preenchidas_programa);
+  console_printf("| PÁGINAS ZERADAS           | %-10d |\n", self->metricas.num_preenchidas_zero);
+  console_printf("| PÁGINAS COMPARTILHADAS    | %-10d |\n", self->metricas.num_compartilhadas);
+  console_printf("| CÓPIAS NA ESCRITA         | %-10d |\n", self->metricas.num_copias_escrita);
+  console_printf("| ESCRITAS SEM CÓPIA        | %-10d |\n", self->metricas.num_escritas_sem_copia);
+  console_printf("| IMAGENS REAPROVEITADAS    | %-10d |\n", cache_imagens_acertos(self->imagens));
+  console_printf("| PROCESSOS POR FORK        | %-10d |\n", self->metricas.num_forks);
+  console_printf("| EXAMINADOS P/ MESCLAGEM   | %-10d |\n", self->metricas.num_examinados_mescla);
+  console_printf("| PÁGINAS MESCLADAS         | %-10d |\n", self->metricas.num_mescladas);
+  console_printf("| MESCLAS DESFEITAS         | %-10d |\n", self->metricas.num_desfeitas_mescla);
+  console_printf("| SUBSTITUIÇÕES LOCAIS      | %-10d |\n", self->metricas.num_substituicoes_locais);
+  console_printf("| LIBERADOS ACIMA DO LIMITE | %-10d |\n", self->metricas.num_liberados_limite);
+  console_printf("| CHAMADAS SO_ESCR_STR      | %-10d |\n", self->metricas.num_escritas_str);
+  console_printf("| CARACTERES SO_ESCR_STR    | %-10d |\n", self->metricas.num_caracteres_str);
+  console_printf("| CHAMADAS SO_LE_LINHA      | %-10d |\n", self->metricas.num_leituras_linha);
+  console_printf("| CARACTERES SO_LE_LINHA    | %-10d |\n", self->metricas.num_caracteres_linha);
+
+  console_printf("\nMEMÓRIA SECUNDÁRIA (blocos de %d palavras):\n", self->tam_pagina);
+  console_printf("| %-26s | %-10s |\n", "MÉTRICA", "VALOR");
+  console_printf("|---------------------------|------------|\n");
+  console_printf("| BLOCOS TOTAIS             | %-10d |\n", swap_n_blocos(self->swap));
+  console_printf("| BLOCOS LIVRES             | %-10d |\n", swap_n_livres(self->swap));
+  console_printf("| PICO DE BLOCOS EM USO     | %-10d |\n", swap_pico_uso(self->swap));
+  console_printf("| EXTENSÕES LIVRES          | %-10d |\n", swap_n_extensoes_livres(self->swap));
+  console_printf("| MAIOR EXTENSÃO LIVRE      | %-10d |\n", swap_maior_extensao_livre(self->swap));
+  console_printf("| FALHAS DE ALOC. CONTÍGUA  | %-10d |\n", swap_falhas_contiguo(self->swap));
+
+  int acertos = zswap_n_recuperadas(self->zswap);
+  int buscas = acertos + self->metricas.num_leituras_disco;
+  int comprimidos = zswap_bytes_comprimidos(self->zswap);
+  console_printf("\nRESERVA DE PÁGINAS COMPRIMIDAS (%d bytes):\n", zswap_capacidade(self->zswap));
+  console_printf("| %-26s | %-10s |\n", "MÉTRICA", "VALOR");
+  console_printf("|---------------------------|------------|\n");
+  console_printf("| BYTES EM USO              | %-10d |\n", zswap_bytes_usados(self->zswap));
+  console_printf("| PICO DE BYTES EM USO      | %-10d |\n", zswap_pico_uso(self->zswap));
+  console_printf("| PÁGINAS GUARDADAS         | %-10d |\n", zswap_n_guardadas(self->zswap));
+  console_printf("| PÁGINAS RECUSADAS         | %-10d |\n", zswap_n_recusadas(self->zswap));
+  console_printf("| PÁGINAS RECUPERADAS       | %-10d |\n", acertos);
+  console_printf("| TAXA DE ACERTOS (%%)       | %-10.1f |\n",
+                 buscas == 0 ? 0.0 : 100.0 * acertos / buscas);
+  console_printf("| TAXA DE COMPRESSÃO        | %-10.2f |\n",
+                 comprimidos == 0 ? 0.0 : (double)zswap_bytes_originais(self->zswap) / comprimidos);
+
+  int rebaixamentos = -self->metricas.num_grandes_liberadas;
+  for (int i = 0; i < self->n_procs; i++)
+  {
+    rebaixamentos += tabpag_n_rebaixamentos(self->processos[i]->tabpag);
+  }
+  int amostras = self->metricas.n_amostras_tabelas;
+  console_printf("\nPÁGINAS GRANDES (%d páginas):\n", self->paginas_grandes);
+  console_printf("| %-26s | %-10s |\n", "MÉTRICA", "VALOR");
+  console_printf("|---------------------------|------------|\n");
+  console_printf("| BLOCOS RESERVADOS         | %-10d |\n", self->metricas.num_reservas_grandes);
+  console_printf("| RESERVAS DESFEITAS        | %-10d |\n", self->metricas.num_reservas_desfeitas);
+  console_printf("| PROMOÇÕES                 | %-10d |\n", self->metricas.num_promocoes);
+  console_printf("| PÁGINAS GRANDES DESFEITAS | %-10d |\n", rebaixamentos);
+  console_printf("| MÉDIA DE PÁGINAS MAPEADAS | %-10.1f |\n",
+                 amostras == 0 ? 0.0 : (double)self->metricas.soma_mapeadas / amostras);
+  console_printf("| MÉDIA DE DESCRITORES      | %-10.1f |\n",
+                 amostras == 0 ? 0.0 : (double)self->metricas.soma_descritores / amostras);
+
+  console_printf("\nDISCO (escalonador: %s, deslocamento da cabeça: %d):\n",
+                 fila_disco_nome(self->escalonador_disco), self->metricas.deslocamento_disco);
+  console_printf("| %-14s | %-10s | %-10s |\n", "LATÊNCIA", "LEITURAS", "GRAVAÇÕES");
+  console_printf("|----------------|------------|------------|\n");
+  int concluidos[2] = {0, 0};
+  for (int i = 0; i < N_FAIXAS_LATENCIA; i++)
+  {
+    char faixa[20];
+    if (i < N_FAIXAS_LATENCIA - 1)
+      snprintf(faixa, sizeof(faixa), "< %d", LATENCIA_BASE << i);
+    else
+      snprintf(faixa, sizeof(faixa), ">= %d", LATENCIA_BASE << (i - 1));
+    console_printf("| %-14s | %-10d | %-10d |\n", faixa,
+                   self->metricas.latencia_disco[0][i], self->metricas.latencia_disco[1][i]);
+    concluidos[0] += self->metricas.latencia_disco[0][i];
+    concluidos[1] += self->metricas.latencia_disco[1][i];
+  }
+  console_printf("| %-14s | %-10d | %-10d |\n", "MÉDIA",
+                 concluidos[0] == 0 ? 0 : self->metricas.latencia_disco_total[0] / concluidos[0],
+                 concluidos[1] == 0 ? 0 : self->metricas.latencia_disco_total[1] / concluidos[1]);
+  console_printf("| %-14s | %-10d | %-10d |\n", "MÁXIMA",
+                 self->metricas.latencia_disco_max[0], self->metricas.latencia_disco_max[1]);
+
+  // as maiores esperaram o disco; o tratamento no SO é medido no hospedeiro
+  console_printf("\nFALTAS DE PÁGINA (latência em instruções, da falta até o processo voltar a executar):\n");
+  so_imprime_cabecalho_histogramas("FALTAS");
+  so_imprime_histograma("TODAS                   ", &self->metricas.latencia_faltas);
+  so_imprime_histograma("MENORES                 ", &self->metricas.latencia_faltas_menores);
+  so_imprime_histograma("MAIORES                 ", &self->metricas.latencia_faltas_maiores);
+  so_imprime_histograma("COM GRAVAÇÃO DA VÍTIMA  ", &self->metricas.latencia_faltas_gravacao);
+  so_imprime_histograma("ESPERA NA FILA DO DISCO ", &self->metricas.espera_fila_faltas);
+  so_imprime_histograma("TRATAMENTO NO SO (ns)   ", &self->metricas.ns_faltas);
 
   console_printf("\nINTERRUPÇÕES:\n");
   console_printf("| %-5s | %-10s |\n", "IRQ", "VEZES");
@@ -156,7 +297,7 @@ static void so_imprime_metricas(so_t *self)
     console_printf("| %-5d | %-10d |\n", i, self->metricas.num_interrupcoes[i]);
   }
 
-  console_printf("\nMÉTRICAS DOS PROCESSOS (num quadros: %d):\n ", N_QUADROS);
+  console_printf("\nMÉTRICAS DOS PROCESSOS (num quadros: %d, substituição: %s):\n ", self->n_quadros, so_nome_troca(self));
   for (int i = 0; i < self->n_procs; i++)
   {
     processo_t *proc = self->processos[i];
@@ -168,6 +309,19 @@ static void so_imprime_metricas(so_t *self)
     console_printf("| TEMPO DE RESPOSTA      | %-10d |\n", proc->metricas.tempo_resposta);
     console_printf("| TEMPO DE RETORNO       | %-10d |\n", proc->metricas.tempo_retorno);
     console_printf("| PAGE FAULTS            | %-10d |\n", proc->metricas.qtd_page_fault);
+    console_printf("| MAIOR PFF (JANELA)     | %-10d |\n", proc->metricas.maior_pff);
+    console_printf("| MAIOR CONJ. TRABALHO   | %-10d |\n", proc->metricas.maior_conj_trabalho);
+    console_printf("| SUSPENSÕES             | %-10d |\n", proc->metricas.qtd_suspensoes);
+    console_printf("| RSS                    | %-10d |\n", tabquadros_n_residentes(self->quadros, proc));
+    console_printf("| MAIOR RSS              | %-10d |\n", proc->metricas.maior_rss);
+    console_printf("| LIMITE SUAVE           | %-10d |\n", proc->limite_suave);
+    console_printf("| LIMITE RÍGIDO          | %-10d |\n", proc->limite_rigido);
+    console_printf("| FALTAS MAIORES         | %-10d |\n", proc->metricas.qtd_faltas_maiores);
+
+    console_printf("\nFALTAS DE PÁGINA DO PROCESSO %d:\n\n ", proc->pid);
+    so_imprime_cabecalho_histogramas("FALTAS");
+    so_imprime_histograma("LATÊNCIA (instruções)   ", &proc->metricas.latencia_faltas);
+    so_imprime_histograma("TRATAMENTO NO SO (ns)   ", &proc->metricas.ns_faltas);
 
     console_printf("\nMÉTRICAS POR ESTADO DO PROCESSO %d:\n\n ", proc->pid);
     console_printf("| %-10s | %-10s | %-12s |\n", "ESTADO", "VEZES", "TEMPO TOTAL");
@@ -234,6 +388,54 @@ static void inicializa_metricas(so_t *self)
   self->metricas.tempo_total_execucao = 0;
   self->metricas.tempo_total_ocioso = 0;
   self->metricas.num_preempcoes = 0;
+  self->metricas.num_suspensoes = 0;
+  self->metricas.num_retomadas = 0;
+  self->metricas.num_leituras_disco = 0;
+  self->metricas.num_gravacoes_disco = 0;
+  self->metricas.num_cancelamentos_disco = 0;
+  self->metricas.num_antecipadas = 0;
+  self->metricas.num_antecipadas_usadas = 0;
+  self->metricas.num_antecipadas_perdidas = 0;
+  self->metricas.num_liberados_daemon = 0;
+  self->metricas.num_limpezas_daemon = 0;
+  self->metricas.num_faltas_com_gravacao = 0;
+  self->metricas.num_resgates = 0;
+  self->metricas.num_preenchidas_programa = 0;
+  self->metricas.num_preenchidas_zero = 0;
+  self->metricas.num_compartilhadas = 0;
+  self->metricas.num_copias_escrita = 0;
+  self->metricas.num_escritas_sem_copia = 0;
+  self->metricas.num_forks = 0;
+  self->metricas.num_examinados_mescla = 0;
+  self->metricas.num_mescladas = 0;
+  self->metricas.num_desfeitas_mescla = 0;
+  self->metricas.num_reservas_grandes = 0;
+  self->metricas.num_reservas_desfeitas = 0;
+  self->metricas.num_promocoes = 0;
+  self->metricas.num_grandes_liberadas = 0;
+  self->metricas.num_substituicoes_locais = 0;
+  self->metricas.num_liberados_limite = 0;
+  self->metricas.soma_descritores = 0;
+  self->metricas.soma_mapeadas = 0;
+  self->metricas.n_amostras_tabelas = 0;
+  for (int op = 0; op < 2; op++)
+  {
+    for (int i = 0; i < N_FAIXAS_LATENCIA; i++)
+      self->metricas.latencia_disco[op][i] = 0;
+    self->metricas.latencia_disco_total[op] = 0;
+    self->metricas.latencia_disco_max[op] = 0;
+  }
+  self->metricas.deslocamento_disco = 0;
+  self->metricas.num_escritas_str = 0;
+  self->metricas.num_caracteres_str = 0;
+  self->metricas.num_leituras_linha = 0;
+  self->metricas.num_caracteres_linha = 0;
+  histograma_zera(&self->metricas.latencia_faltas);
+  histograma_zera(&self->metricas.latencia_faltas_menores);
+  histograma_zera(&self->metricas.latencia_faltas_maiores);
+  histograma_zera(&self->metricas.latencia_faltas_gravacao);
+  histograma_zera(&self->metricas.espera_fila_faltas);
+  histograma_zera(&self->metricas.ns_faltas);
 
   for (int i = 0; i < QTD_IRQ; i++)
   {
@@ -283,8 +485,22 @@ static void inicializa_cpu(so_t *self)
   }
 }
 
-so_t *so_cria(cpu_t *cpu, mem_t *mem, mem_t *mem_sec, mmu_t *mmu, es_t *es, console_t *console)
+char *so_confere_geometria(geometria_t *geometria)
+{
+  // os quadros seguintes aos do SO são os da reserva de páginas comprimidas,
+  //   e os processos usam os outros
+  int primeiro_quadro = geometria_primeiro_quadro(geometria) + QUADROS_ZSWAP;
+  if (geometria->n_quadros - primeiro_quadro < LIMITE_RIGIDO_MIN)
+    return "os quadros não bastam para o SO, a reserva de páginas comprimidas"
+           " e as páginas de uma instrução";
+  return NULL;
+}
+
+so_t *so_cria(cpu_t *cpu, mem_t *mem, mem_t *mem_sec, mmu_t *mmu, es_t *es, console_t *console,
+              geometria_t *geometria)
 {
+  if (so_confere_geometria(geometria) != NULL)
+    return NULL;
   so_t *self = malloc(sizeof(*self));
   if (self == NULL)
     return NULL;
@@ -296,6 +512,9 @@ so_t *so_cria(cpu_t *cpu, mem_t *mem, mem_t *mem_sec, mmu_t *mmu, es_t *es, cons
   self->es = es;
   self->console = console;
   self->erro_interno = false;
+  self->tam_pagina = geometria->tam_pagina;
+  self->n_quadros = geometria->n_quadros;
+  self->paginas_grandes = geometria->paginas_grandes;
   self->processo_corrente = NULL;
   self->pid_atual = 1;
   self->quantum_proc = QUANTUM;
@@ -313,11 +532,38 @@ so_t *so_cria(cpu_t *cpu, mem_t *mem, mem_t *mem_sec, mmu_t *mmu, es_t *es, cons
   //   contém o endereço 99 (as 100 primeiras posições de memória (pelo menos)
   //   não vão ser usadas por programas de usuário)
   // t2: o controle de memória livre deve ser mais aprimorado que isso
-  self->quadro_livre = 0;
-  self->quadro_livre_primaria = 99 / TAM_PAGINA + 1;
+  // os quadros seguintes são os da reserva de páginas comprimidas
+  int primeiro_quadro = geometria_primeiro_quadro(geometria) + QUADROS_ZSWAP;
+  self->quadros = tabquadros_cria(self->n_quadros, primeiro_quadro);
+  self->algoritmo_troca = ALGORITMO_TROCA;
+  self->ponteiro_mescla = 0;
+  self->tiques_janela = 0;
+
+  // a memória secundária é dividida em blocos do tamanho de uma página,
+  //   alocados aos processos na criação e liberados quando morrem
+  self->swap = swap_cria(mem_tam(mem_sec) / self->tam_pagina);
+  self->zswap = zswap_cria(swap_n_blocos(self->swap), QUADROS_ZSWAP * self->tam_pagina * (int)sizeof(int));
 
   self->fifo = fifo_cria();
 
+  self->transitos = calloc(self->n_quadros, sizeof(transito_t));
+  if (self->transitos == NULL)
+  {
+    console_printf("SO: erro ao alocar a tabela de transferências com o disco");
+    self->erro_interno = true;
+  }
+  self->escalonador_disco = ESCALONADOR_DISCO;
+  self->fila_disco = fila_disco_cria(ESCALONADOR_DISCO);
+  self->imagens = cache_imagens_cria();
+  self->disco_ocupado = false;
+  for (int terminal = 0; terminal < N_TERMINAIS; terminal++)
+  {
+    self->telas[terminal].inicio = 0;
+    self->telas[terminal].n = 0;
+    self->teclados[terminal].inicio = 0;
+    self->teclados[terminal].n = 0;
+  }
+
   return self;
 }
 
@@ -327,9 +573,19 @@ void so_destroi(so_t *self)
 
   for (int i = 0; i < self->n_procs; i++)
   {
+    free(self->processos[i]->blocos_swap);
+    free(self->processos[i]->origem);
+    free(self->processos[i]->ultima_ref);
     free(self->processos[i]);
   }
   free(self->processos);
+  swap_destroi(self->swap);
+  zswap_destroi(self->zswap);
+  tabquadros_destroi(self->quadros);
+  fifo_destroi(self->fifo);
+  free(self->transitos);
+  fila_disco_destroi(self->fila_disco);
+  cache_imagens_destroi(self->imagens);
 
   no_fila_t *no_atual = self->fila_prontos->inicio;
   while (no_atual != NULL)
@@ -349,6 +605,8 @@ void so_destroi(so_t *self)
 static void so_salva_estado_da_cpu(so_t *self);
 static void so_trata_irq(so_t *self, int irq);
 static void so_trata_pendencias(so_t *self);
+static void so_retoma_se_ocioso(so_t *self);
+static void so_controla_carga(so_t *self);
 static void so_escalona(so_t *self, int escalonador);
 static void so_escalona_simples(so_t *self);
 static void so_escalona_round_robin(so_t *self);
@@ -368,6 +626,12 @@ static int so_para(so_t *self)
 
   so_imprime_metricas(self);
 
+  // grava a imagem da memória secundária, se ela estiver em um arquivo
+  if (mem_sincroniza(self->mem_secundaria) != ERR_OK)
+  {
+    console_printf("SO: erro ao gravar a memória secundária");
+  }
+
   return 1;
 }
 
@@ -380,6 +644,15 @@ static bool algo_pra_fazer(so_t *self)
       return true;
     }
   }
+  // o que ainda está nos buffers das telas é escrito nas próximas
+  //   interrupções do relógio
+  for (int terminal = 0; terminal < N_TERMINAIS; terminal++)
+  {
+    if (self->telas[terminal].n > 0)
+    {
+      return true;
+    }
+  }
   return false;
 }
 
@@ -490,26 +763,16 @@ static void insere_na_fila_prontos(so_t *self, processo_t *proc)
   self->fila_prontos->fim = novo_no;
 }
 
-static bool disco_disponivel(so_t *self, int tempo_pedido)
+static void so_trata_pendencias(so_t *self)
 {
-  int tempo_atual_disco = tempo_atual(self);
-
-  if (tempo_atual_disco >= self->hora_disco_livre)
-  {
-    // Disco está livre, atualiza próximo horário livre
-    self->hora_disco_livre = tempo_atual_disco + tempo_pedido;
-    return true;
-  }
-  else
+  // escreve o que for possível dos buffers das telas, e guarda o que foi
+  //   digitado nos buffers dos teclados
+  for (int terminal = 0; terminal < N_TERMINAIS; terminal++)
   {
-    // Disco ocupado, soma o tempo pedido ao tempo que já vai levar
-    self->hora_disco_livre += tempo_pedido;
-    return false;
+    so_esvazia_tela(self, terminal);
+    so_enche_teclado(self, terminal);
   }
-}
 
-static void so_trata_pendencias(so_t *self)
-{
   for (int i = 0; self->processos[i] != NULL; i++)
   {
     processo_t *proc = self->processos[i];
@@ -517,23 +780,32 @@ static void so_trata_pendencias(so_t *self)
     if (proc->estado == ESTADO_BLOQUEADO)
     {
       int terminal = so_obtem_terminal(proc->pid);
-      int dispositivo_teclado = calcula_dispositivo(D_TERM_A_TECLADO_OK, terminal);
       int dispositivo_tela = calcula_dispositivo(D_TERM_A_TELA_OK, terminal);
 
-      int estado_teclado, estado_tela;
+      int estado_tela;
 
       switch (proc->motivo_bloqueio)
       {
       case R_BLOQ_LEITURA:
-        // se o dispositivo de teclado está pronto, le
-        if (es_le(self->es, dispositivo_teclado, &estado_teclado) == ERR_OK && estado_teclado != 0)
+        // refaz a chamada quando houver caractere no buffer do teclado
+        if (self->teclados[terminal].n > 0)
+        {
+          proc_muda_estado(proc, ESTADO_PRONTO);
+        }
+        break;
+      case R_BLOQ_LEITURA_LINHA:
+        // continua a chamada quando o buffer do teclado tiver o que falta
+        //   da linha
+        if (so_linha_pronta(&self->teclados[terminal], proc->le_max - proc->le_feitos))
         {
           proc_muda_estado(proc, ESTADO_PRONTO);
         }
         break;
       case R_BLOQ_ESCRITA:
-        // se o dispositivo de tela está pronto, escreve
-        if (es_le(self->es, dispositivo_tela, &estado_tela) == ERR_OK && estado_tela != 0)
+        // se o dispositivo de tela está pronto, escreve (depois do que está
+        //   no buffer da tela)
+        if (self->telas[terminal].n == 0 &&
+            es_le(self->es, dispositivo_tela, &estado_tela) == ERR_OK && estado_tela != 0)
         {
           if (es_escreve(self->es, calcula_dispositivo(D_TERM_A_TELA, terminal), proc->dado_pendente) == ERR_OK)
           {
@@ -541,6 +813,13 @@ static void so_trata_pendencias(so_t *self)
           }
         }
         break;
+      case R_BLOQ_ESCRITA_STR:
+        // continua a chamada quando o buffer da tela estiver até a metade
+        if (self->telas[terminal].n <= TAM_BUF_TELA / 2)
+        {
+          proc_muda_estado(proc, ESTADO_PRONTO);
+        }
+        break;
       case R_BLOQ_ESPERA_PROC:
         // verifica se o processo esperado já morreu
         for (int j = 0; self->processos[j] != NULL; j++)
@@ -553,7 +832,12 @@ static void so_trata_pendencias(so_t *self)
         }
         break;
       case R_BLOQ_ESPERA_DISCO:
-        if (proc->hora_desbloqueio < tempo_atual(self))
+        // é desbloqueado quando o disco termina de ler a página (so_trata_irq_disco)
+        break;
+      case R_BLOQ_ESPERA_QUADRO:
+        // é desbloqueado quando o disco conclui uma transferência
+        //   (so_trata_irq_disco); se não há nenhuma, não tem o que esperar
+        if (!so_ha_quadro_em_transito(self))
         {
           proc_muda_estado(proc, ESTADO_PRONTO);
         }
@@ -569,6 +853,7 @@ static void so_trata_pendencias(so_t *self)
       }
     }
   }
+  so_retoma_se_ocioso(self);
 }
 static void atualiza_estado_processo_corrente(so_t *self)
 {
@@ -800,14 +1085,46 @@ static void so_escalona_prioridade(so_t *self)
   }
 }
 
+// o processo voltou a executar depois de uma falta de página; registra a
+//   latência dela
+static void so_registra_fim_falta(so_t *self, processo_t *proc)
+{
+  so_metricas_t *m = &self->metricas;
+  int latencia = tempo_atual(self) - proc->inicio_falta;
+  proc->inicio_falta = -1;
+  histograma_registra(&proc->metricas.latencia_faltas, latencia);
+  histograma_registra(&m->latencia_faltas, latencia);
+  if (proc->falta_maior)
+  {
+    proc->metricas.qtd_faltas_maiores++;
+    histograma_registra(&m->latencia_faltas_maiores, latencia);
+    histograma_registra(&m->espera_fila_faltas, proc->espera_fila_falta);
+  }
+  else
+  {
+    histograma_registra(&m->latencia_faltas_menores, latencia);
+  }
+  if (proc->falta_com_gravacao)
+  {
+    histograma_registra(&m->latencia_faltas_gravacao, latencia);
+  }
+}
+
 static int so_despacha(so_t *self)
 {
   if (self->processo_corrente == NULL || self->erro_interno)
   {
     return 1;
   }
+  if (self->processo_corrente->inicio_falta != -1 &&
+      !self->processo_corrente->refaz_falta &&
+      self->processo_corrente->estado == ESTADO_EXECUTANDO)
+  {
+    so_registra_fim_falta(self, self->processo_corrente);
+  }
   // configura a MMU para usar a tabela de páginas do processo corrente
   mmu_define_tabpag(self->mmu, self->processo_corrente->tabpag);
+  mmu_define_pid(self->mmu, self->processo_corrente->pid);
   // escreve o PC e os registradores do processo corrente nos endereços onde a CPU recupera o estado
   mem_escreve(self->mem, IRQ_END_PC, self->processo_corrente->pc);
   mem_escreve(self->mem, IRQ_END_A, self->processo_corrente->reg[0]);
@@ -827,6 +1144,7 @@ static void so_trata_irq_reset(so_t *self);
 static void so_trata_irq_chamada_sistema(so_t *self);
 static void so_trata_irq_err_cpu(so_t *self);
 static void so_trata_irq_relogio(so_t *self);
+static void so_trata_irq_disco(so_t *self);
 static void so_trata_irq_desconhecida(so_t *self, int irq);
 
 static void so_trata_irq(so_t *self, int irq)
@@ -846,10 +1164,82 @@ static void so_trata_irq(so_t *self, int irq)
   case IRQ_RELOGIO:
     so_trata_irq_relogio(self);
     break;
+  case IRQ_DISCO:
+    so_trata_irq_disco(self);
+    break;
   default:
     so_trata_irq_desconhecida(self, irq);
   }
 }
+// endereço na memória secundária onde está o início da página 'pagina'
+static int so_end_sec(so_t *self, processo_t *proc, int pagina)
+{
+  return proc->blocos_swap[pagina] * self->tam_pagina;
+}
+
+// aloca na memória secundária um bloco para cada página do processo, de
+//   preferência contíguos (menos deslocamento no disco)
+static bool so_aloca_swap_processo(so_t *self, processo_t *proc, int n_paginas)
+{
+  proc->blocos_swap = malloc(n_paginas * sizeof(int));
+  if (proc->blocos_swap == NULL)
+  {
+    console_printf("SO: erro ao alocar o mapa de blocos do processo %d", proc->pid);
+    return false;
+  }
+  proc->n_paginas = n_paginas;
+
+  int primeiro = swap_aloca_contiguo(self->swap, n_paginas);
+  for (int pag = 0; pag < n_paginas; pag++)
+  {
+    if (primeiro != -1)
+    {
+      proc->blocos_swap[pag] = primeiro + pag;
+      continue;
+    }
+    // não tem espaço contíguo, usa blocos espalhados
+    proc->blocos_swap[pag] = swap_aloca(self->swap);
+    if (proc->blocos_swap[pag] == -1)
+    {
+      console_printf("SO: memória secundária cheia, processo %d não cabe", proc->pid);
+      proc->n_paginas = pag;
+      return false;
+    }
+  }
+  return true;
+}
+
+// devolve o bloco da memória secundária; se ninguém mais usa o bloco, a
+//   página dele que estiver na reserva de páginas comprimidas é descartada
+static void so_libera_bloco(so_t *self, int bloco)
+{
+  swap_libera(self->swap, bloco);
+  if (!swap_ocupado(self->swap, bloco))
+  {
+    zswap_remove(self->zswap, bloco);
+  }
+}
+
+// devolve os blocos do processo na memória secundária, e a imagem do
+//   programa de onde vêm as páginas
+static void so_libera_swap_processo(so_t *self, processo_t *proc)
+{
+  for (int pag = 0; pag < proc->n_paginas; pag++)
+  {
+    so_libera_bloco(self, proc->blocos_swap[pag]);
+  }
+  free(proc->blocos_swap);
+  proc->blocos_swap = NULL;
+  free(proc->origem);
+  proc->origem = NULL;
+  if (proc->imagem != NULL)
+  {
+    cache_imagens_devolve(self->imagens, proc->imagem);
+    proc->imagem = NULL;
+  }
+  proc->n_paginas = 0;
+}
+
 static processo_t *aloca_processo()
 {
   processo_t *proc = malloc(sizeof(processo_t));
@@ -860,7 +1250,7 @@ static processo_t *aloca_processo()
   return proc;
 }
 
-static void inicializa_processo(processo_t *proc, int pid, int pc)
+static void inicializa_processo(processo_t *proc, int pid, int pc, int paginas_grandes)
 {
   proc->pid = pid;
   proc->pc = pc;
@@ -871,10 +1261,28 @@ static void inicializa_processo(processo_t *proc, int pid, int pc)
   proc->complemento = 0;
   proc->erro = 0;
   proc->modo = usuario;
-  proc->sec_inicial = 0;
+  proc->end_virt_fim = -1;
+  proc->n_paginas = 0;
+  proc->blocos_swap = NULL;
+  proc->origem = NULL;
+  proc->imagem = NULL;
+  proc->ultima_ref = NULL;
+  proc->conj_trabalho = 0;
+  proc->faltas_janela = 0;
+  proc->pff = 0;
+  proc->hora_suspensao = 0;
+  proc->prox_pag_seq = 0;
+  proc->janela_antecipacao = 0;
+  proc->limite_suave = LIMITE_SUAVE;
+  proc->limite_rigido = LIMITE_RIGIDO;
+  proc->inicio_falta = -1;
+  proc->refaz_falta = false;
+  proc->escr_feitos = 0;
+  proc->le_feitos = 0;
+  proc->le_max = 0;
 
   // criar a tabela de páginas para o processo
-  proc->tabpag = tabpag_cria();
+  proc->tabpag = tabpag_cria(paginas_grandes);
   if (proc->tabpag == NULL)
   {
     console_printf("SO: erro ao criar tabela de páginas para processo %d", pid);
@@ -885,6 +1293,13 @@ static void inicializa_processo(processo_t *proc, int pid, int pc)
   proc->metricas.tempo_retorno = 0;
   proc->metricas.tempo_resposta = 0;
   proc->metricas.qtd_page_fault = 0;
+  proc->metricas.qtd_suspensoes = 0;
+  proc->metricas.maior_conj_trabalho = 0;
+  proc->metricas.maior_pff = 0;
+  proc->metricas.maior_rss = 0;
+  histograma_zera(&proc->metricas.latencia_faltas);
+  histograma_zera(&proc->metricas.ns_faltas);
+  proc->metricas.qtd_faltas_maiores = 0;
   for (int i = 0; i < ESTADO_N; i++)
   {
     proc->metricas.estados[i].qtd = 0;
@@ -903,13 +1318,15 @@ static processo_t *so_cria_processo(so_t *self, char *nome_do_executavel)
   }
 
   int novo_pid = self->pid_atual++;
-  inicializa_processo(proc, novo_pid, 0);
+  inicializa_processo(proc, novo_pid, 0, self->paginas_grandes);
 
   int pc = so_carrega_programa(self, proc, nome_do_executavel);
   console_printf("SO: processo %d criado com PC=%d", novo_pid, pc);
   if (pc == -1)
   {
     console_printf("SO: erro ao carregar o programa '%s'", nome_do_executavel);
+    so_libera_swap_processo(self, proc);
+    free(proc->ultima_ref);
     free(proc);
     return NULL;
   }
@@ -957,7 +1374,8 @@ static void so_verifica_espera(so_t *self, int pid_morto)
 {
   for (int i = 0; self->processos[i] != NULL; i++)
   {
-    if (self->processos[i]->estado == ESTADO_BLOQUEADO)
+    if (self->processos[i]->estado == ESTADO_BLOQUEADO &&
+        self->processos[i]->motivo_bloqueio == R_BLOQ_ESPERA_PROC)
     {
       self->processos[i]->estado = ESTADO_PRONTO;
       console_printf("SO: processo %d desbloqueado após a morte do processo %d", self->processos[i]->pid, pid_morto);
@@ -965,204 +1383,1804 @@ static void so_verifica_espera(so_t *self, int pid_morto)
   }
 }
 
-bool tem_quadro_livre(so_t *self)
+bool pag_alterada(pagina_t *pag)
 {
-  return self->quadro_livre_primaria < N_QUADROS;
+  return tabpag_bit_alteracao(pag->tab_pag, pag->num);
 }
 
-void bloqueia_por_espera_disco(so_t *self)
+// preenche 'pag' com a página que está no quadro 'quadro'
+static void so_pagina_do_quadro(so_t *self, int quadro, pagina_t *pag)
 {
-  self->processo_corrente->hora_desbloqueio = 0;
-  proc_muda_estado(self->processo_corrente, ESTADO_BLOQUEADO);
-  self->processo_corrente->motivo_bloqueio = R_BLOQ_ESPERA_DISCO;
-
-  if (!disco_disponivel(self, TEMPO_DISCO))
-  {
-    self->processo_corrente->hora_desbloqueio = self->processo_corrente->hora_desbloqueio + TEMPO_DISCO + self->hora_disco_livre;
-    return;
-  }
-  else
-  {
-    self->processo_corrente->hora_desbloqueio = TEMPO_DISCO + tempo_atual(self);
-  }
+  quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+  pag->num = q->pagina;
+  pag->processo = q->processo;
+  pag->quadro_num = quadro;
+  pag->tab_pag = q->tabpag;
+  pag->next = NULL;
 }
 
-void so_carrega_pag_para_mem_sec(so_t *self, int quadro, pagina_t *pag)
+// ALGORITMOS DE SUBSTITUIÇÃO DE PÁGINAS {{{2
+
+// cada algoritmo escolhe a página a ser retirada da memória principal,
+//   colocando seus dados em 'pag'; retorna false se não conseguir escolher
+// se 'local' não for NULL, só as páginas desse processo podem ser escolhidas
+//   (substituição local); senão, as de qualquer processo
+
+// pega a primeira página da fila, ou a primeira do processo 'local'
+static bool so_pega_da_fila(so_t *self, processo_t *local, pagina_t *pag)
 {
-  bloqueia_por_espera_disco(self);
+  if (local != NULL)
+    return fifo_pega_processo(self->fifo, local, pag);
+  if (fifo_vazia(self->fifo))
+    return false;
+  fifo_pega(self->fifo, pag);
+  return true;
+}
 
-  int end_sec = pag->num * TAM_PAGINA + pag->processo->sec_inicial;
+static bool so_troca_fifo(so_t *self, processo_t *local, pagina_t *pag)
+{
+  return so_pega_da_fila(self, local, pag);
+}
 
-  for (int i = 0; i < TAM_PAGINA; i++)
+static bool so_troca_segunda_chance(so_t *self, processo_t *local, pagina_t *pag)
+{
+  while (so_pega_da_fila(self, local, pag))
   {
-    self->processo_corrente->hora_desbloqueio += TEMPO_DISCO;
-    int dado;
-    if (mem_le(self->mem, quadro * TAM_PAGINA + i, &dado) != ERR_OK)
+    bool acessada = tabpag_bit_acesso(pag->tab_pag, pag->num);
+    if (!acessada)
     {
-      console_printf("SO: erro ao ler da memória principal");
-      self->erro_interno = true;
-      return;
-    }
-    console_printf("SO: ESCREVENDO MEM SEC POIS FOI ALTERADA prim[%d]=v[%d]=sec[%d]=%d", quadro * TAM_PAGINA + i, pag->num * TAM_PAGINA + i, end_sec + i, dado);
-    if (mem_escreve(self->mem_secundaria, end_sec + i, dado) != ERR_OK)
-    {
-      console_printf("SO: erro ao escrever na memória secundária");
-      self->erro_interno = true;
-      return;
+      return true;
     }
+    tabpag_zera_bit_acesso(pag->tab_pag, pag->num);
+
+    fifo_insere_pagina(self->fifo, pag->num, pag->quadro_num, pag->tab_pag, pag->processo);
   }
+  return false;
 }
 
-void so_copia_mem_sec_para_prim(so_t *self, int end_sec, int quadro, int pagina)
+// para os algoritmos que escolhem pela tabela de quadros
+static bool so_troca_quadro(so_t *self, int quadro, pagina_t *pag)
 {
-  bloqueia_por_espera_disco(self);
-  for (int i = 0; i < TAM_PAGINA; i++)
-  {
-    int dado;
-    if (mem_le(self->mem_secundaria, end_sec + i, &dado) != ERR_OK)
-    {
-      console_printf("SO: erro ao ler da memória secundária");
-      self->erro_interno = true;
-      return;
-    }
-    console_printf("prim[%d]=v[%d]=sec[%d]=%d", quadro * TAM_PAGINA + i, pagina * TAM_PAGINA + i, end_sec + i, dado);
-    if (mem_escreve(self->mem, quadro * TAM_PAGINA + i, dado) != ERR_OK)
-    {
-      console_printf("SO: erro ao escrever na memória principal");
-      self->erro_interno = true;
-      return;
-    }
-  }
+  if (quadro == -1)
+    return false;
+  so_pagina_do_quadro(self, quadro, pag);
+  return true;
 }
 
-bool pag_alterada(pagina_t *pag)
+static bool so_troca_clock(so_t *self, processo_t *local, pagina_t *pag)
 {
-  return tabpag_bit_alteracao(pag->tab_pag, pag->num);
+  return so_troca_quadro(self, tabquadros_escolhe_clock(self->quadros, local), pag);
 }
 
-int so_tabpag_escolhe_vitima(so_t *self, int algoritmo_escolha_vitima_t)
+static bool so_troca_wsclock(so_t *self, processo_t *local, pagina_t *pag)
 {
-  pagina_t *pag_vitima = malloc(sizeof(pagina_t));
-  if (algoritmo_escolha_vitima_t == TROCA_FIFO)
-  {
+  int quadro = tabquadros_escolhe_wsclock(self->quadros, local, tempo_atual(self), WSCLOCK_TAU);
+  return so_troca_quadro(self, quadro, pag);
+}
 
-    fifo_pega(self->fifo, pag_vitima);
+static bool so_troca_envelhecimento(so_t *self, processo_t *local, pagina_t *pag)
+{
+  return so_troca_quadro(self, tabquadros_escolhe_envelhecimento(self->quadros, local), pag);
+}
 
-    if (pag_vitima == NULL)
-    {
-      console_printf("SO: erro ao escolher vítima");
-      self->erro_interno = true;
-      return -1;
-    }
-  }
-  else if (algoritmo_escolha_vitima_t == TROCA_SEGUNDA_CHANCE)
-  {
-    while (true)
-    {
-      fifo_pega(self->fifo, pag_vitima);
+static bool so_troca_nfu(so_t *self, processo_t *local, pagina_t *pag)
+{
+  return so_troca_quadro(self, tabquadros_escolhe_nfu(self->quadros, local), pag);
+}
 
-      bool acessada = tabpag_bit_acesso(pag_vitima->tab_pag, pag_vitima->num);
-      if (!acessada)
-      {
-        break;
-      }
-      else
-      {
-        tabpag_zera_bit_acesso(pag_vitima->tab_pag, pag_vitima->num);
+static bool so_troca_lfu(so_t *self, processo_t *local, pagina_t *pag)
+{
+  return so_troca_quadro(self, tabquadros_escolhe_lfu(self->quadros, local), pag);
+}
 
-        fifo_insere_pagina(self->fifo, pag_vitima->num, pag_vitima->quadro_num, pag_vitima->tab_pag, pag_vitima->processo);
-      }
-    }
-  }
-  else
-  {
-    console_printf("SO: algoritmo de substituição de página desconhecido");
-    self->erro_interno = true;
-    return -1;
-  }
-  if (pag_alterada(pag_vitima))
-  {
-    so_carrega_pag_para_mem_sec(self, pag_vitima->quadro_num, pag_vitima);
-  }
-  int quadro;
-  tabpag_traduz(self->processo_corrente->tabpag, pag_vitima->num, &quadro);
-  tabpag_invalida_pagina(pag_vitima->tab_pag, pag_vitima->num);
+// descrição de um algoritmo de substituição
+typedef struct
+{
+  // nome, usado para escolher o algoritmo e nas métricas
+  char *nome;
+  // o algoritmo usa a fila de páginas na ordem de carga
+  bool usa_fifo;
+  // o algoritmo precisa que os bits de acesso sejam amostrados a cada
+  //   interrupção do relógio
+  bool usa_amostragem;
+  // função que escolhe a vítima
+  bool (*escolhe)(so_t *self, processo_t *local, pagina_t *pag);
+} algoritmo_troca_t;
+
+static algoritmo_troca_t algoritmos_troca[N_TROCA] = {
+    [TROCA_FIFO] = {"fifo", true, false, so_troca_fifo},
+    [TROCA_SEGUNDA_CHANCE] = {"segunda_chance", true, false, so_troca_segunda_chance},
+    [TROCA_CLOCK] = {"clock", false, false, so_troca_clock},
+    [TROCA_WSCLOCK] = {"wsclock", false, false, so_troca_wsclock},
+    [TROCA_ENVELHECIMENTO] = {"envelhecimento", false, true, so_troca_envelhecimento},
+    [TROCA_NFU] = {"nfu", false, true, so_troca_nfu},
+    [TROCA_LFU] = {"lfu", false, false, so_troca_lfu},
+};
+
+static algoritmo_troca_t *so_troca(so_t *self)
+{
+  return &algoritmos_troca[self->algoritmo_troca];
+}
 
-  return pag_vitima->quadro_num;
+static char *so_nome_troca(so_t *self)
+{
+  return so_troca(self)->nome;
 }
 
-int so_pega_quadro(so_t *self)
+bool so_define_troca(so_t *self, char *nome)
 {
-  if (tem_quadro_livre(self))
+  for (int i = 0; i < N_TROCA; i++)
   {
-
-    self->quadro_livre_primaria++;
-    return self->quadro_livre_primaria - 1;
+    if (strcasecmp(algoritmos_troca[i].nome, nome) == 0)
+    {
+      self->algoritmo_troca = i;
+      return true;
+    }
   }
-  else
+  return false;
+}
+
+// a página do quadro vai sair da memória; se foi trazida por leitura
+//   antecipada, contabiliza se chegou a ser usada, e se não foi, diminui a
+//   antecipação do processo
+static void so_confere_antecipada(so_t *self, int quadro)
+{
+  quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+  if (!q->antecipada)
+    return;
+  q->antecipada = false;
+  if (tabquadros_foi_acessado(self->quadros, quadro))
   {
-    // se não houver espaço, escolhe uma página para substituir
-    console_printf("SO: Memoria principal encheu escolhendo um quadro para retirar uma pagina.");
-    return so_tabpag_escolhe_vitima(self, TROCA_SEGUNDA_CHANCE);
+    self->metricas.num_antecipadas_usadas++;
+    return;
   }
+  self->metricas.num_antecipadas_perdidas++;
+  q->processo->janela_antecipacao /= 2;
 }
 
-bool verifica_segmentation_fault(int complemento, processo_t *processo)
+// COMPARTILHAMENTO DE PÁGINAS {{{2
+
+// as páginas com origem no programa são mapeadas somente para leitura, em
+//   quadros que podem ser compartilhados pelos processos que executam a
+//   mesma imagem; um processo criado por SO_FORK compartilha da mesma forma
+//   todas as páginas que o pai tem na memória principal, e usa os mesmos
+//   blocos da memória secundária para as outras
+// a primeira escrita de um processo em uma página compartilhada causa
+//   ERR_PAG_PROTEGIDA, e o processo passa a ter a sua cópia da página (ver
+//   so_trata_pag_protegida)
+// uma página compartilhada é sempre a mesma página nos processos (a imagem
+//   tem o mesmo endereço de carga em todos, e o mesclador só junta páginas
+//   com o mesmo número)
+// um quadro compartilhado pode ter alterações que ainda não foram gravadas;
+//   todos os processos que o mapeiam têm o bit de alteração ligado, e quando
+//   ele sai da memória, a página é gravada em um bloco que passa a ser de
+//   todos eles
+
+// retorna true se o processo mapeia o quadro 'quadro'
+static bool so_mapeia_quadro(so_t *self, processo_t *proc, int quadro)
 {
+  quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+  int quadro_pag;
+  return tabpag_traduz(proc->tabpag, q->pagina, &quadro_pag) == ERR_OK && quadro_pag == quadro;
+}
 
-  int end_virtual_final = processo->sec_final - processo->sec_inicial;
-
-  if (complemento < 0 || complemento > end_virtual_final)
-    return true;
-
-  return false;
+// retorna um quadro compartilhado com a página 'pagina' da imagem do
+//   processo, ou -1
+static int so_quadro_compartilhado(so_t *self, processo_t *proc, int pagina)
+{
+  for (int quadro = 0; quadro < self->n_quadros; quadro++)
+  {
+    quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+    if (tabquadros_residente(self->quadros, quadro) && q->do_programa &&
+        q->pagina == pagina && q->processo->imagem == proc->imagem)
+    {
+      return quadro;
+    }
+  }
+  return -1;
 }
 
-static void mata_proc_erro_cpu(so_t *self, processo_t *processo)
+// mapeia a página do processo no quadro compartilhado
+static void so_mapeia_compartilhado(so_t *self, processo_t *proc, int pagina, int quadro)
 {
-  console_printf("SO: matando processo %d devido a erro na CPU", processo->pid);
-  so_chamada_mata_proc(self);
-  so_verifica_espera(self, processo->pid);
-  self->erro_interno = true;
-  return;
+  tabpag_define_quadro(proc->tabpag, pagina, quadro);
+  tabpag_define_somente_leitura(proc->tabpag, pagina, true);
+  tabquadros_quadro(self->quadros, quadro)->n_refs++;
+  proc->ultima_ref[pagina] = tempo_atual(self);
+  self->metricas.num_compartilhadas++;
 }
 
-static void so_trata_pag_ausente(so_t *self)
+// passa o quadro compartilhado para o processo 'proc', que o mapeia
+static void so_define_dono(so_t *self, int quadro, processo_t *proc)
 {
-  int end_faltante = self->processo_corrente->complemento;
+  quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+  q->processo = proc;
+  q->tabpag = proc->tabpag;
+  q->acessos_vistos = tabpag_n_acessos(proc->tabpag, q->pagina);
+  if (so_troca(self)->usa_fifo && !fifo_troca_dono(self->fifo, quadro, proc->tabpag, proc))
+  {
+    fifo_insere_pagina(self->fifo, q->pagina, quadro, proc->tabpag, proc);
+  }
+}
 
-  if (verifica_segmentation_fault(end_faltante, self->processo_corrente))
+// o dono do quadro compartilhado vai deixar de mapeá-lo; passa o quadro
+//   para outro processo vivo que o mapeia
+static void so_troca_dono(so_t *self, int quadro)
+{
+  quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+  for (int i = 0; self->processos[i] != NULL; i++)
   {
-    console_printf("SO: SEGMENTATION FAULT");
-    mata_proc_erro_cpu(self, self->processo_corrente);
+    processo_t *proc = self->processos[i];
+    if (proc == q->processo || proc->estado == ESTADO_MORTO || !so_mapeia_quadro(self, proc, quadro))
+      continue;
+    so_define_dono(self, quadro, proc);
     return;
   }
+}
 
-  int pagina = end_faltante / TAM_PAGINA;
+// o processo deixa de mapear o quadro compartilhado, que continua com os
+//   outros
+static void so_desmapeia_quadro(so_t *self, processo_t *proc, int quadro)
+{
+  quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+  tabpag_invalida_pagina(proc->tabpag, q->pagina);
+  q->n_refs--;
+  if (q->processo == proc)
+  {
+    so_troca_dono(self, quadro);
+  }
+}
+
+// a página do processo vai ser gravada; se o bloco dela na memória
+//   secundária é compartilhado com outros processos, que continuam com o
+//   conteúdo antigo, o processo passa a ter um bloco só seu
+static void so_separa_bloco(so_t *self, processo_t *proc, int pagina)
+{
+  int bloco = proc->blocos_swap[pagina];
+  if (swap_n_usos(self->swap, bloco) <= 1)
+    return;
+  int novo = swap_aloca(self->swap);
+  if (novo == -1)
+  {
+    console_printf("SO: memória secundária cheia, página %d do processo %d", pagina, proc->pid);
+    self->erro_interno = true;
+    return;
+  }
+  so_libera_bloco(self, bloco);
+  proc->blocos_swap[pagina] = novo;
+}
+
+// a página da vítima vai sair da memória: invalida ela nas tabelas de
+//   páginas de todos os processos que mapeiam o quadro; se ela está
+//   alterada, vai ser gravada no bloco do dono, que passa a ser o bloco da
+//   página em todos eles
+static void so_invalida_vitima(so_t *self, pagina_t *vitima, bool alterada)
+{
+  quadro_t *q = tabquadros_quadro(self->quadros, vitima->quadro_num);
+  if (alterada)
+  {
+    so_separa_bloco(self, vitima->processo, vitima->num);
+  }
+  int bloco = vitima->processo->blocos_swap[vitima->num];
+  for (int i = 0; q->compartilhada && self->processos[i] != NULL; i++)
+  {
+    processo_t *proc = self->processos[i];
+    if (proc != q->processo && proc->estado != ESTADO_MORTO &&
+        so_mapeia_quadro(self, proc, vitima->quadro_num))
+    {
+      tabpag_invalida_pagina(proc->tabpag, q->pagina);
+      if (alterada)
+      {
+        swap_compartilha(self->swap, bloco);
+        so_libera_bloco(self, proc->blocos_swap[q->pagina]);
+        proc->blocos_swap[q->pagina] = bloco;
+        proc->origem[q->pagina] = ORIGEM_SWAP;
+      }
+    }
+  }
+  tabpag_invalida_pagina(vitima->tab_pag, vitima->num);
+}
+
+// o processo 'filho' passa a usar o espaço de endereçamento do processo
+//   'pai': as páginas que o pai tem na memória principal passam a ser
+//   compartilhadas pelos dois, e as outras vêm dos mesmos blocos da memória
+//   secundária (ou do programa); nenhuma página é copiada
+static bool so_compartilha_espaco(so_t *self, processo_t *pai, processo_t *filho)
+{
+  int n_paginas = pai->n_paginas;
+  filho->blocos_swap = malloc(n_paginas * sizeof(int));
+  filho->origem = malloc(n_paginas * sizeof(origem_pag_t));
+  filho->ultima_ref = malloc(n_paginas * sizeof(int));
+  if (filho->blocos_swap == NULL || filho->origem == NULL || filho->ultima_ref == NULL)
+  {
+    console_printf("SO: erro ao alocar o espaço de endereçamento do processo %d", filho->pid);
+    free(filho->blocos_swap);
+    free(filho->origem);
+    free(filho->ultima_ref);
+    filho->blocos_swap = NULL;
+    filho->origem = NULL;
+    filho->ultima_ref = NULL;
+    return false;
+  }
+  filho->n_paginas = n_paginas;
+  filho->end_virt_fim = pai->end_virt_fim;
+  filho->imagem = pai->imagem;
+  if (filho->imagem != NULL)
+  {
+    cache_imagens_usa(self->imagens, filho->imagem);
+  }
+  for (int pag = 0; pag < n_paginas; pag++)
+  {
+    filho->blocos_swap[pag] = pai->blocos_swap[pag];
+    swap_compartilha(self->swap, pai->blocos_swap[pag]);
+    filho->origem[pag] = pai->origem[pag];
+    filho->ultima_ref[pag] = -1;
+    int quadro;
+    if (tabpag_traduz(pai->tabpag, pag, &quadro) != ERR_OK)
+      continue;
+    quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+    q->compartilhada = true;
+    tabpag_define_somente_leitura(pai->tabpag, pag, true);
+    so_mapeia_compartilhado(self, filho, pag, quadro);
+    if (tabpag_bit_alteracao(q->tabpag, pag))
+    {
+      tabpag_marca_bit_acesso(filho->tabpag, pag, true);
+    }
+  }
+  return true;
+}
+
+// libera os quadros ocupados pelas páginas de um processo que morreu (ou foi
+//   suspenso), e os quadros livres que guardam páginas dele; os quadros
+//   compartilhados com outros processos continuam com eles
+// os quadros em trânsito são tratados por so_cancela_transferencias_processo
+//   (ou so_cancela_leituras_processo, na suspensão)
+static void so_libera_quadros_processo(so_t *self, processo_t *proc)
+{
+  if (so_troca(self)->usa_fifo)
+  {
+    fifo_liberaPags_processo(self->fifo, proc->pid);
+  }
+  self->metricas.num_grandes_liberadas += tabpag_n_grandes(proc->tabpag);
+  for (int quadro = 0; quadro < self->n_quadros; quadro++)
+  {
+    quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+    if (tabquadros_residente(self->quadros, quadro) && q->compartilhada && q->n_refs > 1 &&
+        so_mapeia_quadro(self, proc, quadro))
+    {
+      so_desmapeia_quadro(self, proc, quadro);
+    }
+    else if (tabquadros_residente(self->quadros, quadro) && q->processo == proc)
+    {
+      so_confere_antecipada(self, quadro);
+      tabpag_invalida_pagina(q->tabpag, q->pagina);
+      tabquadros_libera(self->quadros, quadro);
+    }
+    else if (q->guardada && q->processo == proc)
+    {
+      tabquadros_libera(self->quadros, quadro);
+    }
+    if (q->reserva_proc == proc)
+    {
+      q->reserva_proc = NULL;
+    }
+  }
+}
+
+// PÁGINAS GRANDES {{{2
+
+// as páginas de um processo são agrupadas em regiões alinhadas de
+//   'paginas_grandes' páginas; quando falta uma página de uma região que
+//   está inteira no espaço de endereçamento, o SO reserva para a região um
+//   bloco alinhado de quadros livres, e cada página da região vai para o
+//   seu quadro no bloco; quando todas as páginas da região estão nos seus
+//   quadros, têm a mesma proteção e já foram usadas, a tabela de páginas
+//   passa a ter um só descritor para elas (ver tabpag.h); as páginas do
+//   programa compartilhadas entre processos podem formar uma página grande
+//   em cada um deles
+// os quadros reservados livres só são usados para outras páginas quando não
+//   há outro quadro livre; aí a reserva da região é desfeita
+// uma página grande é desfeita (volta a ter um descritor por página) quando
+//   uma das páginas sai da memória, muda de proteção ou de quadro; as
+//   páginas continuam reservadas, e a região pode ser promovida de novo
+
+// quadro reservado para a página do processo, se ele está livre; reserva
+//   um bloco para a região da página se ela ainda não tiver
+// retorna -1 se a página não tem quadro reservado livre
+static int so_quadro_reservado(so_t *self, processo_t *proc, int pagina)
+{
+  int n = self->paginas_grandes;
+  if (n == 0)
+    return -1;
+  int primeira = pagina - pagina % n;
+  if (primeira + n > proc->n_paginas)
+    return -1;
+  int quadro = tabquadros_procura_reserva(self->quadros, proc, pagina);
+  if (quadro == -1)
+  {
+    int bloco = tabquadros_reserva_grande(self->quadros, n, proc, primeira);
+    if (bloco == -1)
+      return -1;
+    self->metricas.num_reservas_grandes++;
+    quadro = bloco + pagina % n;
+  }
+  if (tabquadros_quadro(self->quadros, quadro)->ocupado)
+    return -1;
+  return quadro;
+}
+
+// retorna true se a página do processo pode ir para o quadro sem desfazer
+//   reservas: o quadro é o reservado para ela, ou nem o quadro nem a
+//   página estão reservados
+static bool so_quadro_serve(so_t *self, int quadro, processo_t *proc, int pagina)
+{
+  quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+  if (q->reserva_proc != NULL)
+    return q->reserva_proc == proc && q->reserva_pagina == pagina;
+  return self->paginas_grandes == 0 ||
+         tabquadros_procura_reserva(self->quadros, proc, pagina) == -1;
+}
+
+// a página do processo vai ocupar o quadro; se o quadro está reservado para
+//   outra página, a reserva do bloco é desfeita
+static void so_usa_quadro(so_t *self, int quadro, processo_t *proc, int pagina)
+{
+  quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+  if (q->reserva_proc == NULL || (q->reserva_proc == proc && q->reserva_pagina == pagina))
+    return;
+  tabquadros_desfaz_reserva(self->quadros, quadro, self->paginas_grandes);
+  self->metricas.num_reservas_desfeitas++;
+}
+
+// promove a página grande que contém a página do processo, se todas as
+//   páginas da região estão residentes e já foram usadas (tabpag_promove
+//   confere se estão em quadros consecutivos alinhados, com a mesma proteção)
+static void so_tenta_promover(so_t *self, processo_t *proc, int pagina)
+{
+  int n = self->paginas_grandes;
+  if (n == 0 || tabpag_em_grande(proc->tabpag, pagina))
+    return;
+  int primeira = pagina - pagina % n;
+  if (primeira + n > proc->n_paginas)
+    return;
+  for (int pag = primeira; pag < primeira + n; pag++)
+  {
+    int quadro;
+    if (tabpag_traduz(proc->tabpag, pag, &quadro) != ERR_OK ||
+        !tabquadros_residente(self->quadros, quadro))
+    {
+      return;
+    }
+    if (tabquadros_quadro(self->quadros, quadro)->antecipada)
+      return;
+  }
+  if (tabpag_promove(proc->tabpag, pagina))
+  {
+    self->metricas.num_promocoes++;
+  }
+}
+
+// soma os descritores e as páginas mapeadas nas tabelas dos processos vivos
+static void so_amostra_tabelas(so_t *self)
+{
+  for (int i = 0; i < self->n_procs; i++)
+  {
+    processo_t *proc = self->processos[i];
+    if (proc->estado == ESTADO_MORTO)
+      continue;
+    int grandes = tabpag_n_grandes(proc->tabpag);
+    self->metricas.soma_descritores += tabpag_n_entradas(proc->tabpag);
+    self->metricas.soma_mapeadas += tabpag_n_entradas(proc->tabpag) - grandes +
+                                    grandes * self->paginas_grandes;
+  }
+  self->metricas.n_amostras_tabelas++;
+}
+
+// LIMITES DE MEMÓRIA {{{2
+
+// cada processo pode ter um limite suave e um limite rígido para o seu
+//   conjunto residente (RSS: quadros com páginas dele, sem contar os
+//   compartilhados de que ele não é o dono)
+// um processo no limite rígido nunca recebe mais um quadro: a página que
+//   falta substitui uma das páginas dele (substituição local), mesmo com
+//   quadros livres; um processo no limite suave usa quadros livres, mas
+//   quando é preciso substituir uma página, substitui uma das dele em vez de
+//   tirar páginas dos outros; o daemon de paginação também libera primeiro
+//   os quadros dos processos acima do limite suave
+// os outros processos usam a substituição global
+
+// retorna true se o processo tem um limite e o seu RSS já chegou nele
+static bool so_no_limite(so_t *self, processo_t *proc, int limite)
+{
+  return limite > 0 && tabquadros_n_residentes(self->quadros, proc) >= limite;
+}
+
+// número de quadros que o processo ainda pode receber até o limite rígido
+//   (-1 se não tem limite rígido)
+static int so_folga_rigido(so_t *self, processo_t *proc)
+{
+  if (proc->limite_rigido == 0)
+    return -1;
+  int folga = proc->limite_rigido - tabquadros_n_residentes(self->quadros, proc);
+  return folga < 0 ? 0 : folga;
+}
+
+// retorna o processo que está mais acima do seu limite suave, ou NULL se
+//   nenhum está acima
+static processo_t *so_processo_acima_do_limite(so_t *self)
+{
+  processo_t *escolhido = NULL;
+  int maior_excesso = 0;
+  for (int i = 0; self->processos[i] != NULL; i++)
+  {
+    processo_t *proc = self->processos[i];
+    if (proc->estado == ESTADO_MORTO || proc->estado == ESTADO_SUSPENSO ||
+        proc->limite_suave == 0)
+    {
+      continue;
+    }
+    int excesso = tabquadros_n_residentes(self->quadros, proc) - proc->limite_suave;
+    if (excesso > maior_excesso)
+    {
+      escolhido = proc;
+      maior_excesso = excesso;
+    }
+  }
+  return escolhido;
+}
+
+// atualiza o maior RSS do processo, depois de ele receber uma página
+static void so_registra_rss(so_t *self, processo_t *proc)
+{
+  int rss = tabquadros_n_residentes(self->quadros, proc);
+  if (rss > proc->metricas.maior_rss)
+  {
+    proc->metricas.maior_rss = rss;
+  }
+}
+
+// TRANSFERÊNCIAS COM O DISCO {{{2
+
+// as páginas são transferidas entre a memória principal e a secundária pelo
+//   disco, que trabalha em paralelo com a CPU e interrompe quando termina
+//   um pedido; enquanto isso, o quadro fica reservado (em trânsito) e o
+//   processo que precisa da página fica bloqueado, e a CPU executa outros
+//   processos
+// quando a vítima de uma falta de página está alterada, o quadro é gravado
+//   antes de ser lido; o pedido de leitura é feito quando a gravação termina
+// os pedidos esperam na fila do disco, e o SO entrega ao disco um de cada
+//   vez, escolhido pelo escalonador do disco conforme a posição da cabeça
+
+bool so_define_escalonador_disco(so_t *self, char *nome)
+{
+  int politica = fila_disco_politica(nome);
+  if (politica == -1)
+    return false;
+  self->escalonador_disco = politica;
+  fila_disco_define_politica(self->fila_disco, politica);
+  return true;
+}
+
+// se o disco está livre, entrega a ele o próximo pedido da fila
+static void so_despacha_disco(so_t *self)
+{
+  if (self->disco_ocupado)
+    return;
+  int cabeca;
+  if (es_le(self->es, D_DISCO_CABECA, &cabeca) != ERR_OK)
+    cabeca = 0;
+  pedido_disco_t *p = &self->disco_atual;
+  if (!fila_disco_retira(self->fila_disco, cabeca, tempo_atual(self), p))
+    return;
+  // a espera na fila conta para a falta de página que precisa do pedido
+  transito_t *t = &self->transitos[p->etiqueta];
+  if (t->proc_leitura != NULL && !t->antecipada && t->proc_leitura->inicio_falta != -1)
+  {
+    t->proc_leitura->espera_fila_falta += tempo_atual(self) - p->chegada;
+  }
+  err_t e1, e2, e3, e4, e5;
+  e1 = es_escreve(self->es, D_DISCO_END_MIDIA, p->end_sec);
+  e2 = es_escreve(self->es, D_DISCO_END_MEM, p->etiqueta * self->tam_pagina);
+  e3 = es_escreve(self->es, D_DISCO_TAMANHO, p->tamanho);
+  e4 = es_escreve(self->es, D_DISCO_ETIQUETA, p->etiqueta);
+  e5 = es_escreve(self->es, D_DISCO_COMANDO, p->comando);
+  if (e1 != ERR_OK || e2 != ERR_OK || e3 != ERR_OK || e4 != ERR_OK || e5 != ERR_OK)
+  {
+    console_printf("SO: problema no pedido ao disco (quadro %d, end %d)", p->etiqueta, p->end_sec);
+    self->erro_interno = true;
+    return;
+  }
+  self->disco_ocupado = true;
+  self->metricas.deslocamento_disco += abs(p->end_sec - cabeca);
+}
+
+// pede ao disco a transferência de 'n_quadros' páginas entre os quadros a
+//   partir de 'quadro' e a memória secundária, a partir de 'end_sec'
+static void so_pede_disco(so_t *self, int comando, int quadro, int n_quadros, int end_sec)
+{
+  fila_disco_insere(self->fila_disco, comando, end_sec, n_quadros * self->tam_pagina, quadro, tempo_atual(self));
+  if (comando == DISCO_LE)
+    self->metricas.num_leituras_disco++;
+  else
+    self->metricas.num_gravacoes_disco++;
+  so_despacha_disco(self);
+}
+
+// cancela o pedido ao disco do quadro 'quadro'; retorna false se o pedido
+//   já foi concluído (a conclusão ainda vai ser informada pela interrupção)
+static bool so_cancela_disco(so_t *self, int quadro)
+{
+  if (fila_disco_cancela(self->fila_disco, quadro))
+  {
+    self->metricas.num_cancelamentos_disco++;
+    return true;
+  }
+  if (!self->disco_ocupado || self->disco_atual.etiqueta != quadro)
+    return false;
+  if (es_escreve(self->es, D_DISCO_ETIQUETA, quadro) != ERR_OK ||
+      es_escreve(self->es, D_DISCO_COMANDO, DISCO_CANCELA) != ERR_OK)
+  {
+    return false;
+  }
+  self->metricas.num_cancelamentos_disco++;
+  self->disco_ocupado = false;
+  so_despacha_disco(self);
+  return true;
+}
+
+// registra a latência do pedido que o disco concluiu
+static void so_registra_latencia_disco(so_t *self)
+{
+  int op = self->disco_atual.comando == DISCO_LE ? 0 : 1;
+  int latencia = tempo_atual(self) - self->disco_atual.chegada;
+  int faixa = 0;
+  while (faixa < N_FAIXAS_LATENCIA - 1 && latencia >= LATENCIA_BASE << faixa)
+    faixa++;
+  self->metricas.latencia_disco[op][faixa]++;
+  self->metricas.latencia_disco_total[op] += latencia;
+  if (latencia > self->metricas.latencia_disco_max[op])
+    self->metricas.latencia_disco_max[op] = latencia;
+}
+
+static void so_fim_gravacao(so_t *self, int quadro);
+
+// pede a gravação da página 'pagina' do processo, que está no quadro
+//   (reservado); a partir daí, a página passa a vir da memória secundária
+// se a página cabe comprimida na reserva, ela fica lá em vez de ir para o
+//   disco, e a gravação termina na hora
+static void so_pede_gravacao(so_t *self, int quadro, processo_t *proc, int pagina)
+{
+  transito_t *t = &self->transitos[quadro];
+  t->gravando = true;
+  t->proc_gravacao = proc;
+  t->pag_gravacao = pagina;
+  proc->origem[pagina] = ORIGEM_SWAP;
+  int valores[self->tam_pagina];
+  if (mem_le_bloco(self->mem, quadro * self->tam_pagina, self->tam_pagina, valores) == ERR_OK &&
+      zswap_guarda(self->zswap, proc->blocos_swap[pagina], self->tam_pagina, valores))
+  {
+    so_fim_gravacao(self, quadro);
+    return;
+  }
+  so_pede_disco(self, DISCO_GRAVA, quadro, 1, so_end_sec(self, proc, pagina));
+}
+
+// pede a leitura das páginas que vão ocupar o quadro e os seguintes
+//   (transitos[quadro].n_quadros); as páginas estão em blocos consecutivos
+static void so_pede_leitura(so_t *self, int quadro)
+{
+  transito_t *t = &self->transitos[quadro];
+  so_pede_disco(self, DISCO_LE, quadro, t->n_quadros, so_end_sec(self, t->proc_leitura, t->pag_leitura));
+}
+
+static void so_fim_leitura(so_t *self, int quadro);
+
+// preenche o quadro com a página que ainda não foi para a memória
+//   secundária, com os dados do programa ou com zeros, sem usar o disco
+static void so_preenche_quadro(so_t *self, int quadro)
+{
+  transito_t *t = &self->transitos[quadro];
+  processo_t *proc = t->proc_leitura;
+  int pagina = t->pag_leitura;
+  int valores[self->tam_pagina];
+  for (int i = 0; i < self->tam_pagina; i++)
+  {
+    valores[i] = 0;
+  }
+  if (proc->origem[pagina] == ORIGEM_PROGRAMA)
+  {
+    programa_t *programa = imagem_programa(proc->imagem);
+    int end_carga = prog_end_carga(programa);
+    int tamanho = prog_tamanho(programa);
+    int *dados = prog_dados(programa);
+    for (int i = 0; i < self->tam_pagina; i++)
+    {
+      int end = pagina * self->tam_pagina + i - end_carga;
+      if (end >= 0 && end < tamanho)
+        valores[i] = dados[end];
+    }
+    self->metricas.num_preenchidas_programa++;
+  }
+  else
+  {
+    self->metricas.num_preenchidas_zero++;
+  }
+  if (mem_escreve_bloco(self->mem, quadro * self->tam_pagina, self->tam_pagina, valores) != ERR_OK)
+  {
+    console_printf("SO: erro ao preencher o quadro %d", quadro);
+    self->erro_interno = true;
+  }
+  so_fim_leitura(self, quadro);
+}
+
+// traz para o quadro (reservado) a página que está na reserva de páginas
+//   comprimidas, sem usar o disco
+// se só o processo usa o bloco, a página sai da reserva, e fica marcada
+//   como alterada para voltar para ela (ou para o disco) quando sair da
+//   memória principal
+static void so_descomprime_pagina(so_t *self, int quadro)
+{
+  transito_t *t = &self->transitos[quadro];
+  processo_t *proc = t->proc_leitura;
+  int pagina = t->pag_leitura;
+  int bloco = proc->blocos_swap[pagina];
+  int valores[self->tam_pagina];
+  if (!zswap_recupera(self->zswap, bloco, self->tam_pagina, valores) ||
+      mem_escreve_bloco(self->mem, quadro * self->tam_pagina, self->tam_pagina, valores) != ERR_OK)
+  {
+    console_printf("SO: erro ao descomprimir o bloco %d no quadro %d", bloco, quadro);
+    self->erro_interno = true;
+  }
+  bool exclusiva = swap_n_usos(self->swap, bloco) == 1;
+  if (exclusiva)
+  {
+    zswap_remove(self->zswap, bloco);
+  }
+  so_fim_leitura(self, quadro);
+  if (exclusiva)
+  {
+    tabpag_marca_bit_acesso(proc->tabpag, pagina, true);
+  }
+}
+
+static void so_traz_pagina(so_t *self, int quadro);
+
+// copia para o quadro (reservado) a página que o processo mapeia no quadro
+//   compartilhado transitos[quadro].quadro_copia, e o processo deixa de
+//   mapear o compartilhado
+// se enquanto o quadro era reservado a página saiu do compartilhado, ela é
+//   trazida de onde foi parar
+static void so_copia_quadro(so_t *self, int quadro)
+{
+  transito_t *t = &self->transitos[quadro];
+  int origem = t->quadro_copia;
+  t->quadro_copia = -1;
+  if (!tabquadros_residente(self->quadros, origem) ||
+      tabquadros_quadro(self->quadros, origem)->pagina != t->pag_leitura ||
+      !so_mapeia_quadro(self, t->proc_leitura, origem))
+  {
+    so_traz_pagina(self, quadro);
+    return;
+  }
+  int valores[self->tam_pagina];
+  if (mem_le_bloco(self->mem, origem * self->tam_pagina, self->tam_pagina, valores) != ERR_OK ||
+      mem_escreve_bloco(self->mem, quadro * self->tam_pagina, self->tam_pagina, valores) != ERR_OK)
+  {
+    console_printf("SO: erro ao copiar o quadro %d para o quadro %d", origem, quadro);
+    self->erro_interno = true;
+  }
+  so_desmapeia_quadro(self, t->proc_leitura, origem);
+  so_fim_leitura(self, quadro);
+}
+
+// traz para o quadro (reservado) a página a ler: da reserva de páginas
+//   comprimidas ou do disco, se ela está na memória secundária, direto do
+//   programa, ou de um quadro compartilhado
+static void so_traz_pagina(so_t *self, int quadro)
+{
+  transito_t *t = &self->transitos[quadro];
+  if (t->quadro_copia != -1)
+  {
+    so_copia_quadro(self, quadro);
+  }
+  else if (t->proc_leitura->origem[t->pag_leitura] == ORIGEM_SWAP &&
+           zswap_contem(self->zswap, t->proc_leitura->blocos_swap[t->pag_leitura]))
+  {
+    so_descomprime_pagina(self, quadro);
+  }
+  else if (t->proc_leitura->origem[t->pag_leitura] == ORIGEM_SWAP)
+  {
+    so_pede_leitura(self, quadro);
+  }
+  else
+  {
+    so_preenche_quadro(self, quadro);
+  }
+}
+
+// termina a gravação da página que estava no quadro; se não há leitura, o
+//   quadro fica livre guardando a página (a não ser que o processo tenha
+//   morrido, e a gravação sido cancelada)
+static void so_fim_gravacao(so_t *self, int quadro)
+{
+  transito_t *t = &self->transitos[quadro];
+  processo_t *proc = t->proc_gravacao;
+  bool mesma_pagina = t->proc_leitura == proc && t->pag_leitura == t->pag_gravacao;
+  t->gravando = false;
+  t->proc_gravacao = NULL;
+  if (t->proc_leitura != NULL && mesma_pagina)
+  {
+    // a página faltou enquanto era gravada, e continua no quadro
+    self->metricas.num_resgates++;
+    so_fim_leitura(self, quadro);
+  }
+  else if (t->proc_leitura != NULL)
+  {
+    so_traz_pagina(self, quadro);
+  }
+  else if (proc != NULL)
+  {
+    tabquadros_guarda(self->quadros, quadro);
+  }
+  else
+  {
+    tabquadros_libera(self->quadros, quadro);
+  }
+}
+
+// a página lida está no quadro: coloca ela na tabela de páginas do processo
+//   e desbloqueia o processo
+static void so_fim_leitura(so_t *self, int quadro)
+{
+  transito_t *t = &self->transitos[quadro];
+  processo_t *proc = t->proc_leitura;
+  if (proc == NULL)
+  {
+    // o processo morreu enquanto a página era lida
+    tabquadros_libera(self->quadros, quadro);
+    return;
+  }
+  t->proc_leitura = NULL;
+  int pagina = t->pag_leitura;
+  int agora = tempo_atual(self);
+  tabpag_define_quadro(proc->tabpag, pagina, quadro);
+  bool limitado = proc->limite_suave > 0 || proc->limite_rigido > 0;
+  tabquadros_ocupa(self->quadros, quadro, proc, proc->tabpag, pagina, agora, limitado);
+  if (proc->origem[pagina] == ORIGEM_PROGRAMA && !t->privada)
+  {
+    tabpag_define_somente_leitura(proc->tabpag, pagina, true);
+    tabquadros_quadro(self->quadros, quadro)->compartilhada = true;
+    tabquadros_quadro(self->quadros, quadro)->do_programa = true;
+  }
+  else if (t->privada)
+  {
+    // a página copiada pode ter alterações que não estão na origem
+    tabpag_marca_bit_acesso(proc->tabpag, pagina, true);
+  }
+  if (so_troca(self)->usa_fifo)
+  {
+    fifo_insere_pagina(self->fifo, pagina, quadro, proc->tabpag, proc);
+  }
+  if (t->antecipada)
+  {
+    // só entra no conjunto de trabalho se for usada
+    tabquadros_quadro(self->quadros, quadro)->antecipada = true;
+    return;
+  }
+  proc->ultima_ref[pagina] = agora;
+  // a página conta como acessada até o processo voltar a executar; senão,
+  //   com poucos quadros, ela é escolhida como vítima antes de ser usada
+  //   e o processo falta nela de novo
+  tabpag_marca_bit_acesso(proc->tabpag, pagina, false);
+  so_registra_rss(self, proc);
+  if (proc->estado == ESTADO_BLOQUEADO && proc->motivo_bloqueio == R_BLOQ_ESPERA_DISCO)
+  {
+    proc_muda_estado(proc, ESTADO_PRONTO);
+    insere_na_fila_prontos(self, proc);
+  }
+  so_tenta_promover(self, proc, pagina);
+}
+
+// o disco concluiu o pedido do quadro 'quadro'
+static void so_conclui_transferencia(so_t *self, int quadro)
+{
+  if (quadro < 0 || quadro >= self->n_quadros || !tabquadros_quadro(self->quadros, quadro)->em_transito)
+  {
+    console_printf("SO: disco concluiu pedido desconhecido (%d)", quadro);
+    self->erro_interno = true;
+    return;
+  }
+  if (self->transitos[quadro].gravando)
+  {
+    so_fim_gravacao(self, quadro);
+    return;
+  }
+  int n_quadros = self->transitos[quadro].n_quadros;
+  for (int i = 0; i < n_quadros; i++)
+  {
+    so_fim_leitura(self, quadro + i);
+  }
+}
+
+// retorna o quadro em trânsito com a página 'pagina' do processo (sendo
+//   lida para ele ou gravada), ou -1
+static int so_quadro_em_transito(so_t *self, processo_t *proc, int pagina)
+{
+  for (int quadro = 0; quadro < self->n_quadros; quadro++)
+  {
+    quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+    if (q->em_transito && q->processo == proc && q->pagina == pagina)
+    {
+      return quadro;
+    }
+  }
+  return -1;
+}
+
+// cancela as leituras de páginas para o processo; a leitura que o disco
+//   já começou termina com o quadro sendo liberado (so_fim_leitura)
+static void so_cancela_leituras_processo(so_t *self, processo_t *proc)
+{
+  for (int quadro = 0; quadro < self->n_quadros; quadro++)
+  {
+    if (!tabquadros_quadro(self->quadros, quadro)->em_transito)
+      continue;
+    transito_t *t = &self->transitos[quadro];
+    if (t->proc_leitura == proc)
+    {
+      t->proc_leitura = NULL;
+      // os quadros seguintes de uma leitura de várias páginas são do mesmo
+      //   processo, e são liberados junto com o primeiro
+      if (!t->gravando && t->n_quadros > 0 && so_cancela_disco(self, quadro))
+      {
+        for (int i = 0; i < t->n_quadros; i++)
+          tabquadros_libera(self->quadros, quadro + i);
+      }
+    }
+  }
+}
+
+// cancela as transferências de um processo que morreu; os quadros que o
+//   disco ainda vai usar são liberados quando ele terminar
+static void so_cancela_transferencias_processo(so_t *self, processo_t *proc)
+{
+  so_cancela_leituras_processo(self, proc);
+  for (int quadro = 0; quadro < self->n_quadros; quadro++)
+  {
+    if (!tabquadros_quadro(self->quadros, quadro)->em_transito)
+      continue;
+    transito_t *t = &self->transitos[quadro];
+    // a gravação tem que ser cancelada, porque os blocos do processo vão ser
+    //   reaproveitados; se o disco já está gravando, o quadro é liberado
+    //   quando ele terminar
+    // se o bloco também é de outros processos (a página estava em um quadro
+    //   compartilhado), a gravação continua, e é o conteúdo da página deles
+    if (t->gravando && t->proc_gravacao == proc)
+    {
+      t->proc_gravacao = NULL;
+      if (swap_n_usos(self->swap, proc->blocos_swap[t->pag_gravacao]) == 1 &&
+          so_cancela_disco(self, quadro))
+      {
+        so_fim_gravacao(self, quadro);
+      }
+    }
+  }
+}
+
+static void so_bloqueia_espera_disco(so_t *self, processo_t *proc)
+{
+  proc_muda_estado(proc, ESTADO_BLOQUEADO);
+  proc->motivo_bloqueio = R_BLOQ_ESPERA_DISCO;
+}
+
+// o processo espera o disco liberar um quadro, e causa a falta de novo
+static void so_bloqueia_espera_quadro(so_t *self, processo_t *proc)
+{
+  proc_muda_estado(proc, ESTADO_BLOQUEADO);
+  proc->motivo_bloqueio = R_BLOQ_ESPERA_QUADRO;
+  proc->refaz_falta = true;
+}
+
+static bool so_ha_quadro_em_transito(so_t *self)
+{
+  for (int quadro = 0; quadro < self->n_quadros; quadro++)
+  {
+    if (tabquadros_quadro(self->quadros, quadro)->em_transito)
+      return true;
+  }
+  return false;
+}
+
+// desbloqueia os processos que esperam um quadro, para refazerem a falta
+static void so_acorda_espera_quadro(so_t *self)
+{
+  for (int i = 0; self->processos[i] != NULL; i++)
+  {
+    processo_t *proc = self->processos[i];
+    if (proc->estado == ESTADO_BLOQUEADO && proc->motivo_bloqueio == R_BLOQ_ESPERA_QUADRO)
+    {
+      proc_muda_estado(proc, ESTADO_PRONTO);
+      insere_na_fila_prontos(self, proc);
+    }
+  }
+}
+
+// LEITURA ANTECIPADA {{{2
+
+// quando as faltas de página de um processo são sequenciais (cada uma na
+//   página seguinte à última lida), o SO lê junto com a página que faltou as
+//   seguintes, no mesmo pedido ao disco, se houver quadros livres logo
+//   depois do quadro escolhido; o número de páginas antecipadas dobra a cada
+//   falta que continua a sequência, volta a zero quando ela é quebrada e cai
+//   pela metade quando uma página antecipada sai da memória sem ser usada
+
+// atualiza a antecipação do processo para uma falta na página 'pagina'
+static void so_atualiza_antecipacao(processo_t *proc, int pagina)
+{
+  if (pagina != proc->prox_pag_seq)
+  {
+    proc->janela_antecipacao = 0;
+  }
+  else if (proc->janela_antecipacao == 0)
+  {
+    proc->janela_antecipacao = 1;
+  }
+  else if (proc->janela_antecipacao < MAX_ANTECIPACAO)
+  {
+    proc->janela_antecipacao *= 2;
+  }
+}
+
+// número de páginas depois de 'pagina' que podem ser lidas no mesmo pedido:
+//   ausentes, em blocos consecutivos da memória secundária (e não na reserva
+//   de páginas comprimidas), e com quadros livres consecutivos depois de
+//   'quadro' que podem receber essas páginas (ver so_quadro_serve), sem
+//   passar do limite rígido do processo
+static int so_paginas_antecipaveis(so_t *self, processo_t *proc, int pagina, int quadro)
+{
+  int max = proc->janela_antecipacao;
+  int folga = so_folga_rigido(self, proc);
+  if (folga != -1 && folga - 1 < max)
+  {
+    max = folga - 1;
+  }
+  int n = 0;
+  while (n < max)
+  {
+    int pag = pagina + 1 + n;
+    int q = quadro + 1 + n;
+    int quadro_pag;
+    if (pag >= proc->n_paginas || q >= self->n_quadros ||
+        proc->origem[pag] != ORIGEM_SWAP ||
+        proc->blocos_swap[pag] != proc->blocos_swap[pagina] + 1 + n ||
+        zswap_contem(self->zswap, proc->blocos_swap[pag]) ||
+        tabquadros_quadro(self->quadros, q)->ocupado ||
+        !so_quadro_serve(self, q, proc, pag) ||
+        tabpag_traduz(proc->tabpag, pag, &quadro_pag) == ERR_OK ||
+        so_quadro_em_transito(self, proc, pag) != -1 ||
+        tabquadros_procura_guardada(self->quadros, proc, pag) != -1)
+    {
+      break;
+    }
+    n++;
+  }
+  return n;
+}
+
+// DAEMON DE PAGINAÇÃO {{{2
+
+// para que as faltas de página encontrem quadro livre e precisem só de uma
+//   leitura, o SO mantém uma reserva de quadros livres: quando ela fica
+//   abaixo de LIVRES_MIN (verificado a cada interrupção do relógio e a cada
+//   falta de página), o daemon escolhe vítimas com o algoritmo de
+//   substituição até ter LIVRES_ALVO quadros; as vítimas não alteradas são
+//   liberadas na hora, e as alteradas são gravadas antes
+// os quadros liberados continuam guardando a página; se ela faltar antes de
+//   o quadro ser usado por outra, ou enquanto está sendo gravada, ela volta
+//   para o processo sem ser lida do disco
+
+// número de quadros livres, contando os que vão ser liberados quando o disco
+//   terminar de gravar a página que está neles
+static int so_quadros_livres(so_t *self)
+{
+  int n = self->quadros->n_livres;
+  for (int quadro = 0; quadro < self->n_quadros; quadro++)
+  {
+    transito_t *t = &self->transitos[quadro];
+    if (tabquadros_quadro(self->quadros, quadro)->em_transito &&
+        t->gravando && t->proc_leitura == NULL)
+    {
+      n++;
+    }
+  }
+  return n;
+}
+
+// tira da memória a página escolhida pelo algoritmo de substituição (entre
+//   as do processo 'local', se não for NULL); se não está alterada, o quadro
+//   fica livre na hora, guardando a página; senão, fica livre quando o disco
+//   terminar de gravá-la, e '*palterada' é true
+// retorna false se não há página que possa sair
+static bool so_libera_vitima(so_t *self, processo_t *local, bool *palterada)
+{
+  pagina_t vitima;
+  if (!so_troca(self)->escolhe(self, local, &vitima))
+    return false;
+  int quadro = vitima.quadro_num;
+  so_confere_antecipada(self, quadro);
+  bool alterada = pag_alterada(&vitima);
+  so_invalida_vitima(self, &vitima, alterada);
+  if (alterada)
+  {
+    tabquadros_reserva(self->quadros, quadro, vitima.processo, vitima.tab_pag, vitima.num);
+    transito_t *t = &self->transitos[quadro];
+    t->proc_leitura = NULL;
+    t->antecipada = false;
+    t->quadro_copia = -1;
+    t->n_quadros = 1;
+    so_pede_gravacao(self, quadro, vitima.processo, vitima.num);
+  }
+  else
+  {
+    tabquadros_guarda(self->quadros, quadro);
+  }
+  *palterada = alterada;
+  return true;
+}
+
+// tira da memória as páginas do processo que passam do limite rígido (ele
+//   pode ter passado do limite ao mudar de limite, ou ao virar dono de um
+//   quadro compartilhado)
+static void so_reduz_ao_limite(so_t *self, processo_t *proc)
+{
+  bool alterada;
+  while (proc->limite_rigido > 0 &&
+         tabquadros_n_residentes(self->quadros, proc) > proc->limite_rigido &&
+         so_libera_vitima(self, proc, &alterada))
+  {
+    self->metricas.num_liberados_limite++;
+  }
+}
+
+static void so_daemon_paginas(so_t *self)
+{
+  if (!DAEMON_PAGINAS)
+    return;
+  int livres = so_quadros_livres(self);
+  if (livres >= LIVRES_MIN)
+    return;
+  while (livres < LIVRES_ALVO)
+  {
+    // as vítimas são dos processos acima do limite suave, enquanto houver
+    bool alterada;
+    processo_t *local = so_processo_acima_do_limite(self);
+    if (local != NULL && so_libera_vitima(self, local, &alterada))
+    {
+      self->metricas.num_liberados_limite++;
+    }
+    else if (!so_libera_vitima(self, NULL, &alterada))
+    {
+      break;
+    }
+    if (alterada)
+    {
+      self->metricas.num_limpezas_daemon++;
+    }
+    self->metricas.num_liberados_daemon++;
+    livres++;
+  }
+}
+
+// MESCLAGEM DE PÁGINAS IGUAIS {{{2
+
+// a cada interrupção do relógio, o SO examina MESCLA_POR_TIQUE quadros,
+//   continuando de onde parou, e calcula um resumo do conteúdo de cada um;
+//   um quadro que não mudou desde o exame anterior (estável) é comparado com
+//   os outros quadros estáveis com o mesmo resumo e a mesma página; se o
+//   conteúdo é igual, os processos que mapeiam um deles passam a mapear o
+//   outro, como página compartilhada (copiada na primeira escrita), e o
+//   quadro fica livre
+// só páginas com o mesmo número nos processos são mescladas, porque um
+//   quadro compartilhado tem uma só página (ver COMPARTILHAMENTO DE PÁGINAS)
+
+// calcula o resumo (FNV-1a) do conteúdo do quadro
+static bool so_resume_quadro(so_t *self, int quadro, unsigned int *resumo)
+{
+  int valores[self->tam_pagina];
+  if (mem_le_bloco(self->mem, quadro * self->tam_pagina, self->tam_pagina, valores) != ERR_OK)
+    return false;
+  unsigned int h = 2166136261u;
+  for (int i = 0; i < self->tam_pagina; i++)
+  {
+    h = (h ^ (unsigned int)valores[i]) * 16777619u;
+  }
+  *resumo = h;
+  return true;
+}
+
+static bool so_quadros_iguais(so_t *self, int quadro_a, int quadro_b)
+{
+  int a[self->tam_pagina], b[self->tam_pagina];
+  if (mem_le_bloco(self->mem, quadro_a * self->tam_pagina, self->tam_pagina, a) != ERR_OK ||
+      mem_le_bloco(self->mem, quadro_b * self->tam_pagina, self->tam_pagina, b) != ERR_OK)
+  {
+    return false;
+  }
+  for (int i = 0; i < self->tam_pagina; i++)
+  {
+    if (a[i] != b[i])
+      return false;
+  }
+  return true;
+}
+
+// retorna true se o quadro pode ser mesclado: residente, estável, já usado,
+//   fora de página grande, e não é a origem de uma cópia que ainda vai ser
+//   feita
+static bool so_quadro_mesclavel(so_t *self, int quadro)
+{
+  quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+  if (!tabquadros_residente(self->quadros, quadro) || !q->estavel || q->antecipada ||
+      tabpag_em_grande(q->tabpag, q->pagina))
+    return false;
+  for (int outro = 0; outro < self->n_quadros; outro++)
+  {
+    if (tabquadros_quadro(self->quadros, outro)->em_transito &&
+        self->transitos[outro].quadro_copia == quadro)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// os processos que mapeiam o quadro 'origem' passam a mapear o quadro
+//   'destino', que tem o mesmo conteúdo, e 'origem' fica livre
+// se alguma das páginas tinha alterações, todos os processos ficam com o
+//   bit de alteração ligado, para que a página seja gravada ao sair
+static void so_mescla_quadros(so_t *self, int origem, int destino)
+{
+  quadro_t *qo = tabquadros_quadro(self->quadros, origem);
+  quadro_t *qd = tabquadros_quadro(self->quadros, destino);
+  int pagina = qd->pagina;
+  bool alterada = tabpag_bit_alteracao(qo->tabpag, pagina) ||
+                  tabpag_bit_alteracao(qd->tabpag, pagina);
+  if (qo->mesclado || qo->processo->imagem != qd->processo->imagem)
+  {
+    // o quadro passa a ter processos de outra imagem
+    qd->do_programa = false;
+  }
+  qd->compartilhada = true;
+  qd->mesclado = true;
+  tabpag_define_somente_leitura(qd->tabpag, pagina, true);
+  for (int i = 0; self->processos[i] != NULL; i++)
+  {
+    processo_t *proc = self->processos[i];
+    if (proc->estado == ESTADO_MORTO)
+      continue;
+    if (so_mapeia_quadro(self, proc, origem))
+    {
+      tabpag_define_quadro(proc->tabpag, pagina, destino);
+      tabpag_define_somente_leitura(proc->tabpag, pagina, true);
+      qd->n_refs++;
+      self->metricas.num_mescladas++;
+    }
+    if (alterada && so_mapeia_quadro(self, proc, destino))
+    {
+      tabpag_marca_bit_acesso(proc->tabpag, pagina, true);
+    }
+  }
+  if (so_troca(self)->usa_fifo)
+  {
+    fifo_retira_quadro(self->fifo, origem);
+  }
+  tabquadros_libera(self->quadros, origem);
+}
+
+static void so_mescla_paginas(so_t *self)
+{
+  if (!MESCLA_PAGINAS)
+    return;
+  for (int n = 0; n < MESCLA_POR_TIQUE; n++)
+  {
+    int quadro = self->ponteiro_mescla;
+    self->ponteiro_mescla = (quadro + 1) % self->n_quadros;
+    quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+    unsigned int resumo;
+    if (!tabquadros_residente(self->quadros, quadro) || !so_resume_quadro(self, quadro, &resumo))
+      continue;
+    self->metricas.num_examinados_mescla++;
+    q->estavel = q->resumido && q->resumo == resumo;
+    q->resumo = resumo;
+    q->resumido = true;
+    if (!so_quadro_mesclavel(self, quadro))
+      continue;
+    for (int outro = 0; outro < self->n_quadros; outro++)
+    {
+      quadro_t *o = tabquadros_quadro(self->quadros, outro);
+      if (outro == quadro || o->pagina != q->pagina || o->resumo != resumo ||
+          !so_quadro_mesclavel(self, outro) || !so_quadros_iguais(self, quadro, outro))
+      {
+        continue;
+      }
+      // fica o quadro com mais processos, ou o que tem a página do programa
+      if (q->do_programa || (!o->do_programa && q->n_refs > o->n_refs))
+        so_mescla_quadros(self, outro, quadro);
+      else
+        so_mescla_quadros(self, quadro, outro);
+      break;
+    }
+  }
+}
+
+// CONTROLE DE CARGA {{{2
+
+// o conjunto de trabalho de um processo é estimado pelas páginas usadas nas
+//   últimas JANELA_CONJ_TRABALHO instruções, inclusive as que já saíram da
+//   memória principal; a cada interrupção do relógio, as páginas acessadas
+//   desde a anterior têm o instante de uso atualizado
+// se a soma dos conjuntos de trabalho dos processos ativos não cabe nos
+//   quadros disponíveis, os processos passam mais tempo trocando páginas que
+//   executando (thrashing); o escalonador de médio prazo suspende então o
+//   processo pronto com maior taxa de faltas de página, tirando todas as suas
+//   páginas da memória principal. Ele é retomado quando seu conjunto de
+//   trabalho voltar a caber, ou quando nenhum outro processo puder executar.
+
+static void so_amostra_conj_trabalho(so_t *self)
+{
+  int agora = tempo_atual(self);
+  for (int quadro = 0; quadro < self->n_quadros; quadro++)
+  {
+    if (tabquadros_foi_acessado(self->quadros, quadro))
+    {
+      quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+      q->processo->ultima_ref[q->pagina] = agora;
+      if (q->antecipada)
+      {
+        q->antecipada = false;
+        self->metricas.num_antecipadas_usadas++;
+        so_tenta_promover(self, q->processo, q->pagina);
+      }
+    }
+  }
+}
+
+// número de páginas do processo usadas na janela que termina em 'agora'
+static int so_conj_trabalho(processo_t *proc, int agora)
+{
+  int n = 0;
+  for (int pag = 0; pag < proc->n_paginas; pag++)
+  {
+    if (proc->ultima_ref[pag] != -1 && agora - proc->ultima_ref[pag] <= JANELA_CONJ_TRABALHO)
+    {
+      n++;
+    }
+  }
+  return n;
+}
+
+// retira todas as páginas do processo da memória principal, gravando as
+//   alteradas na memória secundária, e tira o processo da disputa pela CPU
+// os quadros com páginas alteradas ficam em trânsito até o disco terminar
+//   de gravá-las; os compartilhados alterados também são gravados (e saem
+//   dos outros processos), senão o processo perderia as alterações
+static void so_suspende_processo(so_t *self, processo_t *proc)
+{
+  console_printf("SO: suspendendo processo %d (conjunto de trabalho %d, PFF %d)",
+                 proc->pid, proc->conj_trabalho, proc->pff);
+  for (int quadro = 0; quadro < self->n_quadros; quadro++)
+  {
+    quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+    if (tabquadros_residente(self->quadros, quadro) && so_mapeia_quadro(self, proc, quadro) &&
+        tabpag_bit_alteracao(q->tabpag, q->pagina))
+    {
+      if (q->processo != proc)
+      {
+        so_define_dono(self, quadro, proc);
+      }
+      pagina_t pag;
+      so_pagina_do_quadro(self, quadro, &pag);
+      so_confere_antecipada(self, quadro);
+      so_invalida_vitima(self, &pag, true);
+      tabquadros_reserva(self->quadros, quadro, pag.processo, pag.tab_pag, pag.num);
+      transito_t *t = &self->transitos[quadro];
+      t->proc_leitura = NULL;
+      t->antecipada = false;
+      t->quadro_copia = -1;
+      t->n_quadros = 1;
+      so_pede_gravacao(self, quadro, pag.processo, pag.num);
+    }
+  }
+  // o processo bloqueado no disco refaz a falta quando for retomado
+  so_cancela_leituras_processo(self, proc);
+  proc->inicio_falta = -1;
+  proc->refaz_falta = false;
+  so_libera_quadros_processo(self, proc);
+  remove_processo_da_lista(self, proc->pid);
+  proc_muda_estado(proc, ESTADO_SUSPENSO);
+  proc->hora_suspensao = tempo_atual(self);
+  proc->metricas.qtd_suspensoes++;
+  self->metricas.num_suspensoes++;
+}
+
+static void so_retoma_processo(so_t *self, processo_t *proc)
+{
+  console_printf("SO: retomando processo %d", proc->pid);
+  // o tempo suspenso não conta para o conjunto de trabalho: as páginas que
+  //   estavam sendo usadas quando foi suspenso continuam no conjunto
+  int agora = tempo_atual(self);
+  for (int pag = 0; pag < proc->n_paginas; pag++)
+  {
+    if (proc->ultima_ref[pag] != -1)
+    {
+      proc->ultima_ref[pag] += agora - proc->hora_suspensao;
+    }
+  }
+  proc_muda_estado(proc, ESTADO_PRONTO);
+  insere_na_fila_prontos(self, proc);
+  self->metricas.num_retomadas++;
+}
+
+// se nenhum processo pode executar nem está esperando o disco, retoma o
+//   processo suspenso há mais tempo, para a CPU não ficar parada
+static void so_retoma_se_ocioso(so_t *self)
+{
+  processo_t *suspenso = NULL;
+  for (int i = 0; self->processos[i] != NULL; i++)
+  {
+    processo_t *proc = self->processos[i];
+    if (proc->estado == ESTADO_PRONTO || proc->estado == ESTADO_EXECUTANDO)
+      return;
+    if (proc->estado == ESTADO_BLOQUEADO && (proc->motivo_bloqueio == R_BLOQ_ESPERA_DISCO ||
+                                             proc->motivo_bloqueio == R_BLOQ_ESPERA_QUADRO))
+      return;
+    if (proc->estado == ESTADO_SUSPENSO && (suspenso == NULL || proc->hora_suspensao < suspenso->hora_suspensao))
+      suspenso = proc;
+  }
+  if (suspenso != NULL)
+  {
+    so_retoma_processo(self, suspenso);
+  }
+}
+
+// escalonador de médio prazo, chamado a cada interrupção do relógio
+static void so_controla_carga(so_t *self)
+{
+  so_amostra_conj_trabalho(self);
+  if (++self->tiques_janela < TIQUES_JANELA)
+    return;
+  self->tiques_janela = 0;
+
+  // fim da janela: atualiza o PFF e o conjunto de trabalho dos processos ativos
+  int agora = tempo_atual(self);
+  int soma_conj_trabalho = 0;
+  int n_ativos = 0;
+  processo_t *vitima = NULL;
+  processo_t *suspenso = NULL;
+  for (int i = 0; self->processos[i] != NULL; i++)
+  {
+    processo_t *proc = self->processos[i];
+    if (proc->estado == ESTADO_MORTO)
+      continue;
+    if (proc->estado == ESTADO_SUSPENSO)
+    {
+      if (suspenso == NULL || proc->hora_suspensao < suspenso->hora_suspensao)
+        suspenso = proc;
+      continue;
+    }
+    proc->pff = proc->faltas_janela;
+    proc->faltas_janela = 0;
+    proc->conj_trabalho = so_conj_trabalho(proc, agora);
+    if (proc->pff > proc->metricas.maior_pff)
+      proc->metricas.maior_pff = proc->pff;
+    if (proc->conj_trabalho > proc->metricas.maior_conj_trabalho)
+      proc->metricas.maior_conj_trabalho = proc->conj_trabalho;
+    soma_conj_trabalho += proc->conj_trabalho;
+    n_ativos++;
+    // podem ser suspensos os processos prontos e os bloqueados esperando
+    //   uma página do disco (ou um quadro para ela); com poucos quadros, os
+    //   que faltam muito passam a maior parte do tempo bloqueados
+    bool suspensivel = proc->estado == ESTADO_PRONTO ||
+                       (proc->estado == ESTADO_BLOQUEADO && (proc->motivo_bloqueio == R_BLOQ_ESPERA_DISCO ||
+                                                             proc->motivo_bloqueio == R_BLOQ_ESPERA_QUADRO));
+    if (suspensivel && proc->pff > 0 &&
+        (vitima == NULL || proc->pff > vitima->pff ||
+         (proc->pff == vitima->pff && proc->conj_trabalho > vitima->conj_trabalho)))
+    {
+      vitima = proc;
+    }
+  }
+
+  if (!CONTROLE_CARGA)
+    return;
+  int disponiveis = self->quadros->n_quadros - self->quadros->primeiro;
+  if (soma_conj_trabalho > disponiveis)
+  {
+    if (vitima != NULL && n_ativos > 1)
+    {
+      so_suspende_processo(self, vitima);
+    }
+  }
+  else if (suspenso != NULL &&
+           soma_conj_trabalho + so_conj_trabalho(suspenso, suspenso->hora_suspensao) <= disponiveis)
+  {
+    so_retoma_processo(self, suspenso);
+  }
+}
+
+bool verifica_segmentation_fault(int complemento, processo_t *processo)
+{
+  if (complemento < 0 || complemento > processo->end_virt_fim)
+    return true;
+
+  return false;
+}
+
+static void mata_proc_erro_cpu(so_t *self, processo_t *processo)
+{
+  console_printf("SO: matando processo %d devido a erro na CPU", processo->pid);
+  so_chamada_mata_proc(self);
+  so_verifica_espera(self, processo->pid);
+  self->erro_interno = true;
+  return;
+}
+
+// no limite rígido, sai uma das páginas do processo antes de voltar uma que
+//   não passa pela escolha de quadro (em trânsito ou guardada em um quadro
+//   livre); retorna false se nenhuma pode sair
+static bool so_abre_espaco_rigido(so_t *self, processo_t *proc)
+{
+  bool alterada;
+  if (!so_no_limite(self, proc, proc->limite_rigido))
+    return true;
+  if (!so_libera_vitima(self, proc, &alterada))
+    return false;
+  self->metricas.num_substituicoes_locais++;
+  return true;
+}
+
+// traz a página 'pagina' do processo para a memória principal: mapeia um
+//   quadro compartilhado que já tenha a página, ou reserva um quadro e traz
+//   a página para ele; se ela vem do disco (ou se a vítima precisa ser
+//   gravada antes), bloqueia o processo até a transferência terminar
+// se 'quadro_copia' não for -1, o processo vai alterar a página, que ele
+//   mapeia no quadro compartilhado 'quadro_copia': ela é copiada de lá para
+//   um quadro que não é compartilhado
+static void so_traz_pagina_ausente(so_t *self, processo_t *proc, int pagina, int quadro_copia)
+{
+  bool privada = quadro_copia != -1;
+
+  // a página pode já estar em trânsito (sendo gravada pelo daemon de
+  //   paginação ou depois de o processo ter sido suspenso); volta para o
+  //   processo quando a gravação terminar
+  int quadro = so_quadro_em_transito(self, proc, pagina);
+  if (quadro != -1)
+  {
+    if (!so_abre_espaco_rigido(self, proc))
+    {
+      console_printf("SO: nenhum quadro disponível para a página %d do processo %d", pagina, proc->pid);
+      so_bloqueia_espera_quadro(self, proc);
+      return;
+    }
+    transito_t *t = &self->transitos[quadro];
+    if (t->proc_leitura == NULL)
+    {
+      t->proc_leitura = proc;
+      t->pag_leitura = pagina;
+    }
+    so_bloqueia_espera_disco(self, proc);
+    return;
+  }
+
+  // a página do programa pode estar em um quadro usado por outro processo
+  //   com a mesma imagem
+  if (!privada && proc->origem[pagina] == ORIGEM_PROGRAMA)
+  {
+    quadro = so_quadro_compartilhado(self, proc, pagina);
+    if (quadro != -1)
+    {
+      so_mapeia_compartilhado(self, proc, pagina, quadro);
+      return;
+    }
+  }
 
-  // verifica se ainda há espaço na memória principal
+  // a página pode estar guardada em um quadro livre; volta sem ser lida, e
+  //   o processo não precisa bloquear; se o processo está no limite rígido,
+  //   antes sai uma das páginas dele
+  quadro = privada ? -1 : tabquadros_procura_guardada(self->quadros, proc, pagina);
+  if (quadro != -1)
+  {
+    if (!so_abre_espaco_rigido(self, proc))
+    {
+      console_printf("SO: nenhum quadro disponível para a página %d do processo %d", pagina, proc->pid);
+      so_bloqueia_espera_quadro(self, proc);
+      return;
+    }
+    so_usa_quadro(self, quadro, proc, pagina);
+    tabquadros_reserva(self->quadros, quadro, proc, proc->tabpag, pagina);
+    transito_t *t = &self->transitos[quadro];
+    t->gravando = false;
+    t->proc_leitura = proc;
+    t->pag_leitura = pagina;
+    t->antecipada = false;
+    t->privada = false;
+    t->quadro_copia = -1;
+    t->n_quadros = 1;
+    self->metricas.num_resgates++;
+    so_fim_leitura(self, quadro);
+    return;
+  }
 
-  int quadro = so_pega_quadro(self);
+  so_reduz_ao_limite(self, proc);
+  so_daemon_paginas(self);
+  pagina_t vitima;
+  bool grava = false;
+  // no limite rígido, a página substitui uma do processo; no suave, também,
+  //   se não houver quadro livre
+  processo_t *local = NULL;
+  bool no_rigido = so_no_limite(self, proc, proc->limite_rigido);
+  quadro = -1;
+  if (no_rigido)
+  {
+    local = proc;
+  }
+  else
+  {
+    quadro = so_quadro_reservado(self, proc, pagina);
+    if (quadro == -1)
+    {
+      quadro = tabquadros_livre(self->quadros);
+    }
+    if (quadro == -1 && so_no_limite(self, proc, proc->limite_suave))
+    {
+      local = proc;
+    }
+  }
+  if (quadro == -1)
+  {
+    // se o processo não tem página que possa sair, a substituição é global,
+    //   a não ser que ele esteja no limite rígido
+    if (local != NULL && so_troca(self)->escolhe(self, local, &vitima))
+    {
+      self->metricas.num_substituicoes_locais++;
+    }
+    else if (no_rigido || !so_troca(self)->escolhe(self, NULL, &vitima))
+    {
+      // todos os quadros (do processo) estão em trânsito; o processo espera
+      //   o disco liberar algum, e causa a falta de novo
+      console_printf("SO: nenhum quadro disponível para a página %d do processo %d", pagina, proc->pid);
+      so_bloqueia_espera_quadro(self, proc);
+      return;
+    }
+    quadro = vitima.quadro_num;
+    so_confere_antecipada(self, quadro);
+    grava = pag_alterada(&vitima);
+    so_invalida_vitima(self, &vitima, grava);
+  }
 
-  // calcula endereço base na memória secundária
-  int end_sec = pagina * TAM_PAGINA + self->processo_corrente->sec_inicial;
+  // as páginas antecipadas só são lidas junto com uma leitura imediata
+  bool do_disco = !privada && proc->origem[pagina] == ORIGEM_SWAP &&
+                  !zswap_contem(self->zswap, proc->blocos_swap[pagina]);
+  int n_quadros = 1;
+  if (!grava && do_disco)
+  {
+    n_quadros += so_paginas_antecipaveis(self, proc, pagina, quadro);
+  }
+  for (int i = 0; i < n_quadros; i++)
+  {
+    so_usa_quadro(self, quadro + i, proc, pagina + i);
+    tabquadros_reserva(self->quadros, quadro + i, proc, proc->tabpag, pagina + i);
+    transito_t *t = &self->transitos[quadro + i];
+    t->gravando = false;
+    t->proc_gravacao = NULL;
+    t->proc_leitura = proc;
+    t->pag_leitura = pagina + i;
+    t->antecipada = i > 0;
+    t->privada = privada;
+    t->quadro_copia = i == 0 ? quadro_copia : -1;
+    t->n_quadros = i == 0 ? n_quadros : 0;
+  }
+  self->metricas.num_antecipadas += n_quadros - 1;
+  proc->prox_pag_seq = pagina + n_quadros;
 
-  // console_printf("SO:sec_inicial=%d", self->processo_corrente->sec_inicial);
-  console_printf("SO: Processo corrente %d", self->processo_corrente->pid);
+  if (grava)
+  {
+    self->metricas.num_faltas_com_gravacao++;
+    proc->falta_com_gravacao = true;
+    so_pede_gravacao(self, quadro, vitima.processo, vitima.num);
+  }
+  else
+  {
+    // se a página não vem do disco, já está no quadro na volta
+    so_traz_pagina(self, quadro);
+  }
+  if (tabquadros_quadro(self->quadros, quadro)->em_transito)
+  {
+    so_bloqueia_espera_disco(self, proc);
+  }
+}
 
-  // copia a página da memória secundária para a principal
-  so_copia_mem_sec_para_prim(self, end_sec, quadro, pagina);
-  escreve_memoria_fisica(self);
+// trata a falta da página que o processo corrente tentou acessar
+static void so_trata_pag_ausente(so_t *self)
+{
+  processo_t *proc = self->processo_corrente;
+  int end_faltante = proc->complemento;
 
-  // marca a página como presente na tabela de páginas
-  tabpag_define_quadro(self->processo_corrente->tabpag, pagina, quadro);
+  if (verifica_segmentation_fault(end_faltante, proc))
+  {
+    console_printf("SO: SEGMENTATION FAULT");
+    mata_proc_erro_cpu(self, proc);
+    return;
+  }
 
-  console_printf("SO: Inserindo página: %d quadro: %d tam_tab: %d processo pid: %d", pagina, quadro, self->processo_corrente->tabpag->tam_tab, self->processo_corrente->pid);
-  fifo_insere_pagina(self->fifo, pagina, quadro, self->processo_corrente->tabpag, self->processo_corrente);
-  print_tabela_paginas(self->processo_corrente->tabpag);
-  fifo_imprime(self->fifo);
+  // a falta refeita depois de esperar um quadro continua a anterior
+  bool refeita = proc->refaz_falta;
+  proc->refaz_falta = false;
+  struct timespec inicio, fim;
+  clock_gettime(CLOCK_MONOTONIC, &inicio);
+  int pagina = end_faltante / self->tam_pagina;
+  if (!refeita)
+  {
+    proc->inicio_falta = tempo_atual(self);
+    proc->falta_com_gravacao = false;
+    proc->espera_fila_falta = 0;
+    so_atualiza_antecipacao(proc, pagina);
+    proc->prox_pag_seq = pagina + 1;
+  }
+  so_traz_pagina_ausente(self, proc, pagina, -1);
+
+  // a falta é maior se o processo vai esperar o disco
+  proc->falta_maior = proc->estado == ESTADO_BLOQUEADO &&
+                      proc->motivo_bloqueio == R_BLOQ_ESPERA_DISCO;
+  clock_gettime(CLOCK_MONOTONIC, &fim);
+  long long ns = (fim.tv_sec - inicio.tv_sec) * 1000000000LL + (fim.tv_nsec - inicio.tv_nsec);
+  if (ns > INT_MAX)
+    ns = INT_MAX;
+  if (!refeita)
+  {
+    histograma_registra(&proc->metricas.ns_faltas, ns);
+    histograma_registra(&self->metricas.ns_faltas, ns);
+  }
+}
 
-  console_printf("SO: Página %d carregada no quadro %d da memória principal", pagina, quadro);
+// trata a escrita do processo corrente em uma página mapeada somente para
+//   leitura: a página é compartilhada; se o processo é o único que usa o
+//   quadro, ele passa a ser privado; senão, o processo recebe uma cópia da
+//   página em outro quadro, e deixa de usar o compartilhado
+static void so_trata_pag_protegida(so_t *self)
+{
+  processo_t *proc = self->processo_corrente;
+  int pagina = proc->complemento / self->tam_pagina;
+  bool refeita = proc->refaz_falta;
+  proc->refaz_falta = false;
+  int quadro;
+  if (tabpag_traduz(proc->tabpag, pagina, &quadro) != ERR_OK ||
+      !tabquadros_quadro(self->quadros, quadro)->compartilhada)
+  {
+    console_printf("SO: escrita em página protegida não compartilhada");
+    mata_proc_erro_cpu(self, proc);
+    return;
+  }
+  quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+  if (q->mesclado && !refeita)
+  {
+    self->metricas.num_desfeitas_mescla++;
+  }
+  if (q->n_refs == 1)
+  {
+    q->compartilhada = false;
+    q->do_programa = false;
+    q->mesclado = false;
+    tabpag_define_somente_leitura(proc->tabpag, pagina, false);
+    self->metricas.num_escritas_sem_copia++;
+    so_tenta_promover(self, proc, pagina);
+    return;
+  }
+  if (!refeita)
+  {
+    self->metricas.num_copias_escrita++;
+  }
+  so_traz_pagina_ausente(self, proc, pagina, quadro);
 }
 
 // interrupção gerada quando a CPU identifica um erro
@@ -1177,10 +3195,19 @@ static void so_trata_irq_err_cpu(so_t *self)
   if (err_int == ERR_PAG_AUSENTE)
   {
     console_printf("SO: Foi causada pelo processo: %d", self->processo_corrente->pid);
-    self->processo_corrente->metricas.qtd_page_fault++;
+    if (!self->processo_corrente->refaz_falta)
+    {
+      self->processo_corrente->metricas.qtd_page_fault++;
+      self->processo_corrente->faltas_janela++;
+    }
     so_trata_pag_ausente(self);
     return;
   }
+  if (err_int == ERR_PAG_PROTEGIDA)
+  {
+    so_trata_pag_protegida(self);
+    return;
+  }
   if (err_int == ERR_END_INV)
   {
     console_printf("SO: Foi causado pelo processo: %d", self->processo_corrente->pid);
@@ -1210,6 +3237,16 @@ static void so_trata_irq_relogio(so_t *self)
     console_printf("SO: problema da reinicialização do timer");
     self->erro_interno = true;
   }
+  // atualiza os contadores dos algoritmos de substituição que dependem de
+  //   amostragem dos bits de acesso
+  if (so_troca(self)->usa_amostragem)
+  {
+    tabquadros_amostra(self->quadros);
+  }
+  so_controla_carga(self);
+  so_daemon_paginas(self);
+  so_mescla_paginas(self);
+  so_amostra_tabelas(self);
   // decrementa o quantum do processo corrente
   if (self->quantum_proc > 0)
   {
@@ -1218,6 +3255,25 @@ static void so_trata_irq_relogio(so_t *self)
   console_printf("Quantum: %d", self->quantum_proc);
 }
 
+// interrupção gerada quando o disco conclui pedidos
+static void so_trata_irq_disco(so_t *self)
+{
+  // cada leitura retira um pedido concluído; quando não há mais, o disco
+  //   deixa de pedir interrupção
+  int quadro;
+  while (es_le(self->es, D_DISCO_CONCLUIDO, &quadro) == ERR_OK && quadro != -1)
+  {
+    if (self->disco_ocupado && self->disco_atual.etiqueta == quadro)
+    {
+      so_registra_latencia_disco(self);
+      self->disco_ocupado = false;
+    }
+    so_conclui_transferencia(self, quadro);
+    so_acorda_espera_quadro(self);
+  }
+  so_despacha_disco(self);
+}
+
 // foi gerada uma interrupção para a qual o SO não está preparado
 static void so_trata_irq_desconhecida(so_t *self, int irq)
 {
@@ -1246,6 +3302,12 @@ static void so_trata_irq_chamada_sistema(so_t *self)
   case SO_ESCR:
     so_chamada_escr(self);
     break;
+  case SO_ESCR_STR:
+    so_chamada_escr_str(self);
+    break;
+  case SO_LE_LINHA:
+    so_chamada_le_linha(self);
+    break;
   case SO_CRIA_PROC:
     so_chamada_cria_proc(self);
     break;
@@ -1255,6 +3317,12 @@ static void so_trata_irq_chamada_sistema(so_t *self)
   case SO_ESPERA_PROC:
     so_chamada_espera_proc(self);
 
+    break;
+  case SO_FORK:
+    so_chamada_fork(self);
+    break;
+  case SO_LIMITA_MEM:
+    so_chamada_limita_mem(self);
     break;
   default:
     console_printf("SO: chamada de sistema desconhecida (%d)", id_chamada);
@@ -1263,46 +3331,105 @@ static void so_trata_irq_chamada_sistema(so_t *self)
   }
 }
 
-// implementação da chamada se sistema SO_LE
-// faz a leitura de um dado da entrada corrente do processo, coloca o dado no reg A
 // Função auxiliar para obter o terminal correspondente ao PID
 static int so_obtem_terminal(int pid)
 {
-  return (pid - 1) % 4;
+  return (pid - 1) % N_TERMINAIS;
 }
 
-static void so_chamada_le(so_t *self)
+// o SO guarda em um buffer os caracteres escritos com SO_ESCR_STR, e os
+//   escreve na tela a cada interrupção, enquanto ela estiver pronta; um
+//   caractere escrito com SO_ESCR quando há caracteres no buffer vai para o
+//   fim dele, para não passar na frente
+// os caracteres digitados em cada terminal também vão para um buffer, a cada
+//   interrupção, e as chamadas de leitura tiram caracteres dele
+
+static void so_tela_poe(buf_tela_t *buf, int dado)
 {
-  int terminal = so_obtem_terminal(self->processo_corrente->pid);
-  int dispositivo = calcula_dispositivo(D_TERM_A_TECLADO, terminal);
-  int dispositivo_ok = calcula_dispositivo(D_TERM_A_TECLADO_OK, terminal);
+  buf->car[(buf->inicio + buf->n) % TAM_BUF_TELA] = dado;
+  buf->n++;
+}
 
-  int estado;
-  if (es_le(self->es, dispositivo_ok, &estado) != ERR_OK)
+static int so_tela_tira(buf_tela_t *buf)
+{
+  int dado = buf->car[buf->inicio];
+  buf->inicio = (buf->inicio + 1) % TAM_BUF_TELA;
+  buf->n--;
+  return dado;
+}
+
+// escreve caracteres do buffer na tela do terminal, enquanto ela aceitar
+static void so_esvazia_tela(so_t *self, int terminal)
+{
+  buf_tela_t *buf = &self->telas[terminal];
+  int dispositivo_tela = calcula_dispositivo(D_TERM_A_TELA, terminal);
+  int dispositivo_tela_ok = calcula_dispositivo(D_TERM_A_TELA_OK, terminal);
+  while (buf->n > 0)
   {
-    console_printf("SO: problema no acesso ao estado do teclado do terminal %d", terminal);
-    self->erro_interno = true;
-    return;
+    int estado;
+    if (es_le(self->es, dispositivo_tela_ok, &estado) != ERR_OK || estado == 0)
+      return;
+    if (es_escreve(self->es, dispositivo_tela, buf->car[buf->inicio]) != ERR_OK)
+      return;
+    buf->inicio = (buf->inicio + 1) % TAM_BUF_TELA;
+    buf->n--;
   }
+}
 
-  if (estado == 0)
+// lê os caracteres digitados no terminal para o buffer do teclado, enquanto
+//   houver caractere e espaço no buffer
+static void so_enche_teclado(so_t *self, int terminal)
+{
+  buf_tela_t *buf = &self->teclados[terminal];
+  int dispositivo_teclado = calcula_dispositivo(D_TERM_A_TECLADO, terminal);
+  int dispositivo_teclado_ok = calcula_dispositivo(D_TERM_A_TECLADO_OK, terminal);
+  while (buf->n < TAM_BUF_TELA)
   {
-    // dispositivo ocupado, bloquear o processo
-    proc_muda_estado(self->processo_corrente, ESTADO_BLOQUEADO);
-    self->processo_corrente->motivo_bloqueio = R_BLOQ_LEITURA; // definindo motivo do bloqueio
-    return;
+    int estado, dado;
+    if (es_le(self->es, dispositivo_teclado_ok, &estado) != ERR_OK || estado == 0)
+      return;
+    if (es_le(self->es, dispositivo_teclado, &dado) != ERR_OK)
+      return;
+    so_tela_poe(buf, dado);
   }
+}
 
-  int dado;
-  if (es_le(self->es, dispositivo, &dado) != ERR_OK)
+// retorna true se um SO_LE_LINHA que ainda precisa de até 'falta'
+//   caracteres pode continuar sem bloquear de novo: o buffer tem um '\n',
+//   tem os caracteres que faltam ou está cheio
+static bool so_linha_pronta(buf_tela_t *buf, int falta)
+{
+  if (buf->n >= falta || buf->n == TAM_BUF_TELA)
+    return true;
+  for (int i = 0; i < buf->n; i++)
   {
-    console_printf("SO: problema no acesso ao teclado do terminal %d", terminal);
-    self->erro_interno = true;
+    if (buf->car[(buf->inicio + i) % TAM_BUF_TELA] == '\n')
+      return true;
+  }
+  return false;
+}
+
+// implementação da chamada se sistema SO_LE
+// tira um caractere do buffer do teclado do processo e coloca no reg A; se
+//   o buffer está vazio, o processo bloqueia e refaz a chamada depois
+static void so_chamada_le(so_t *self)
+{
+  processo_t *proc = self->processo_corrente;
+  int terminal = so_obtem_terminal(proc->pid);
+  buf_tela_t *buf = &self->teclados[terminal];
+
+  so_enche_teclado(self, terminal);
+  if (buf->n == 0)
+  {
+    proc_muda_estado(proc, ESTADO_BLOQUEADO);
+    proc->motivo_bloqueio = R_BLOQ_LEITURA; // definindo motivo do bloqueio
+    proc->pc--;
     return;
   }
 
-  mem_escreve(self->mem, IRQ_END_A, dado);
+  proc->reg[0] = so_tela_tira(buf);
 }
+
 /// implementação da chamada se sistema SO_ESCR
 // escreve o valor do reg X na saída corrente do processo
 static void so_chamada_escr(so_t *self)
@@ -1313,6 +3440,30 @@ static void so_chamada_escr(so_t *self)
   int dispositivo_tela = calcula_dispositivo(D_TERM_A_TELA, terminal);
   int dispositivo_tela_ok = calcula_dispositivo(D_TERM_A_TELA_OK, terminal);
 
+  // se há caracteres no buffer da tela, o caractere vai depois deles
+  buf_tela_t *buf = &self->telas[terminal];
+  if (buf->n > 0)
+  {
+    int dado;
+    if (mem_le(self->mem, IRQ_END_X, &dado) != ERR_OK)
+    {
+      console_printf("SO: problema ao ler o valor do registrador X");
+      self->erro_interno = true;
+      return;
+    }
+    if (buf->n == TAM_BUF_TELA)
+    {
+      self->processo_corrente->dado_pendente = dado;
+      proc_muda_estado(self->processo_corrente, ESTADO_BLOQUEADO);
+      self->processo_corrente->motivo_bloqueio = R_BLOQ_ESCRITA;
+      return;
+    }
+    so_tela_poe(buf, dado);
+    so_esvazia_tela(self, terminal);
+    mem_escreve(self->mem, IRQ_END_A, 0);
+    return;
+  }
+
   // verifica o estado do dispositivo de tela
   int estado;
   if (es_le(self->es, dispositivo_tela_ok, &estado) != ERR_OK)
@@ -1355,6 +3506,146 @@ static void so_chamada_escr(so_t *self)
   mem_escreve(self->mem, IRQ_END_A, 0);
 }
 
+// implementação da chamada de sistema SO_ESCR_STR
+// copia os caracteres da memória do processo para o buffer da tela; se o
+//   buffer enche ou falta uma página, o processo bloqueia e refaz a chamada
+//   depois, continuando do caractere onde parou
+static void so_chamada_escr_str(so_t *self)
+{
+  processo_t *proc = self->processo_corrente;
+  int args[2];
+  for (int i = 0; i < 2; i++)
+  {
+    err_t err = so_le_do_processo(self, proc->reg[1] + i, &args[i], proc);
+    if (err != ERR_OK)
+    {
+      // faltou uma página dos argumentos, vai refazer a chamada
+      if (err == ERR_PAG_AUSENTE)
+        return;
+      console_printf("SO: erro ao ler os argumentos de SO_ESCR_STR");
+      proc->reg[0] = -1;
+      return;
+    }
+  }
+  int end = args[0];
+  int tam = args[1];
+  if (tam < 0)
+  {
+    proc->reg[0] = -1;
+    return;
+  }
+
+  int terminal = so_obtem_terminal(proc->pid);
+  buf_tela_t *buf = &self->telas[terminal];
+  while (proc->escr_feitos < tam)
+  {
+    if (buf->n == TAM_BUF_TELA)
+    {
+      so_esvazia_tela(self, terminal);
+    }
+    if (buf->n == TAM_BUF_TELA)
+    {
+      // refaz a chamada quando houver espaço no buffer
+      proc_muda_estado(proc, ESTADO_BLOQUEADO);
+      proc->motivo_bloqueio = R_BLOQ_ESCRITA_STR;
+      proc->pc--;
+      return;
+    }
+    int dado;
+    err_t err = so_le_do_processo(self, end + proc->escr_feitos, &dado, proc);
+    if (err == ERR_PAG_AUSENTE)
+    {
+      return;
+    }
+    if (err != ERR_OK)
+    {
+      console_printf("SO: erro ao ler o caractere %d de SO_ESCR_STR", proc->escr_feitos);
+      proc->escr_feitos = 0;
+      proc->reg[0] = -1;
+      return;
+    }
+    so_tela_poe(buf, dado);
+    proc->escr_feitos++;
+  }
+  so_esvazia_tela(self, terminal);
+  self->metricas.num_escritas_str++;
+  self->metricas.num_caracteres_str += tam;
+  proc->escr_feitos = 0;
+  proc->reg[0] = tam;
+}
+
+// implementação da chamada de sistema SO_LE_LINHA
+// copia os caracteres do buffer do teclado para a memória do processo, até
+//   um '\n' ou o máximo pedido; um caractere só sai do buffer depois de
+//   escrito na memória. Se o buffer esvazia antes ou falta uma página, o
+//   processo bloqueia e refaz a chamada depois, continuando do caractere
+//   onde parou
+static void so_chamada_le_linha(so_t *self)
+{
+  processo_t *proc = self->processo_corrente;
+  int args[2];
+  for (int i = 0; i < 2; i++)
+  {
+    err_t err = so_le_do_processo(self, proc->reg[1] + i, &args[i], proc);
+    if (err != ERR_OK)
+    {
+      // faltou uma página dos argumentos, vai refazer a chamada
+      if (err == ERR_PAG_AUSENTE)
+        return;
+      console_printf("SO: erro ao ler os argumentos de SO_LE_LINHA");
+      proc->reg[0] = -1;
+      return;
+    }
+  }
+  int end = args[0];
+  int max = args[1];
+  if (max < 0)
+  {
+    proc->reg[0] = -1;
+    return;
+  }
+
+  int terminal = so_obtem_terminal(proc->pid);
+  buf_tela_t *buf = &self->teclados[terminal];
+  bool fim_da_linha = false;
+  while (proc->le_feitos < max && !fim_da_linha)
+  {
+    if (buf->n == 0)
+    {
+      so_enche_teclado(self, terminal);
+    }
+    if (buf->n == 0)
+    {
+      // refaz a chamada quando chegar o resto da linha
+      proc_muda_estado(proc, ESTADO_BLOQUEADO);
+      proc->motivo_bloqueio = R_BLOQ_LEITURA_LINHA;
+      proc->le_max = max;
+      proc->pc--;
+      return;
+    }
+    int dado = buf->car[buf->inicio];
+    err_t err = so_escreve_no_processo(self, end + proc->le_feitos, dado, proc);
+    if (err == ERR_PAG_AUSENTE || err == ERR_PAG_PROTEGIDA)
+    {
+      return;
+    }
+    if (err != ERR_OK)
+    {
+      console_printf("SO: erro ao escrever o caractere %d de SO_LE_LINHA", proc->le_feitos);
+      proc->le_feitos = 0;
+      proc->reg[0] = -1;
+      return;
+    }
+    so_tela_tira(buf);
+    proc->le_feitos++;
+    fim_da_linha = dado == '\n';
+  }
+  self->metricas.num_leituras_linha++;
+  self->metricas.num_caracteres_linha += proc->le_feitos;
+  proc->reg[0] = proc->le_feitos;
+  proc->le_feitos = 0;
+}
+
 static void adiciona_processo_na_lista(so_t *self, processo_t *novo_proc)
 {
   int i = 0;
@@ -1392,6 +3683,12 @@ static void so_chamada_cria_proc(so_t *self)
   char nome[100];
   if (!so_copia_str_do_processo(self, 100, nome, ender_nome, self->processo_corrente))
   {
+    // o processo morreu ou está esperando uma página do nome, e vai refazer
+    //   a chamada
+    if (self->processo_corrente == NULL || self->processo_corrente->estado == ESTADO_BLOQUEADO)
+    {
+      return;
+    }
     console_printf("SO: erro ao copiar o nome do arquivo da memória");
     mem_escreve(self->mem, IRQ_END_A, -1);
     return;
@@ -1407,6 +3704,10 @@ static void so_chamada_cria_proc(so_t *self)
     return;
   }
 
+  // o novo processo herda os limites de memória do criador
+  novo_proc->limite_suave = self->processo_corrente->limite_suave;
+  novo_proc->limite_rigido = self->processo_corrente->limite_rigido;
+
   // adiciona o novo processo à lista de processos
   adiciona_processo_na_lista(self, novo_proc);
 
@@ -1469,6 +3770,11 @@ static void so_chamada_mata_proc(so_t *self)
     if (self->processos[i]->pid == pid)
     {
       proc_muda_estado(self->processos[i], ESTADO_MORTO);
+      so_cancela_transferencias_processo(self, self->processos[i]);
+      so_libera_swap_processo(self, self->processos[i]);
+      free(self->processos[i]->ultima_ref);
+      self->processos[i]->ultima_ref = NULL;
+      so_libera_quadros_processo(self, self->processos[i]);
       if (self->processo_corrente->pid == pid)
       {
         self->processo_corrente = NULL;
@@ -1534,6 +3840,82 @@ static void so_chamada_espera_proc(so_t *self)
   mem_escreve(self->mem, IRQ_END_A, 0);
 }
 
+// implementação da chamada se sistema SO_FORK
+// cria um processo filho que continua a execução do processo corrente, com
+//   o mesmo espaço de endereçamento (compartilhado até ser alterado)
+static void so_chamada_fork(so_t *self)
+{
+  processo_t *pai = self->processo_corrente;
+  processo_t *filho = aloca_processo();
+  if (filho == NULL)
+  {
+    pai->reg[0] = -1;
+    return;
+  }
+  inicializa_processo(filho, self->pid_atual++, pai->pc, self->paginas_grandes);
+  if (filho->tabpag == NULL || !so_compartilha_espaco(self, pai, filho))
+  {
+    console_printf("SO: erro ao criar o filho do processo %d", pai->pid);
+    tabpag_destroi(filho->tabpag);
+    free(filho);
+    pai->reg[0] = -1;
+    return;
+  }
+  // o filho retorna da chamada com 0 em A
+  filho->reg[0] = 0;
+  filho->reg[1] = pai->reg[1];
+  filho->modo = pai->modo;
+  filho->prioridade = pai->prioridade;
+  filho->limite_suave = pai->limite_suave;
+  filho->limite_rigido = pai->limite_rigido;
+  self->n_procs++;
+  self->metricas.num_forks++;
+  console_printf("SO: processo %d criado por fork do processo %d", filho->pid, pai->pid);
+
+  adiciona_processo_na_lista(self, filho);
+  insere_na_fila_prontos(self, filho);
+
+  pai->reg[0] = filho->pid;
+}
+
+// implementação da chamada de sistema SO_LIMITA_MEM
+// define os limites do conjunto residente de um processo
+static void so_chamada_limita_mem(so_t *self)
+{
+  processo_t *proc = self->processo_corrente;
+  int args[3];
+  for (int i = 0; i < 3; i++)
+  {
+    err_t err = so_le_do_processo(self, proc->reg[1] + i, &args[i], proc);
+    if (err != ERR_OK)
+    {
+      // faltou uma página dos argumentos, vai refazer a chamada
+      if (err == ERR_PAG_AUSENTE)
+        return;
+      console_printf("SO: erro ao ler os argumentos de SO_LIMITA_MEM");
+      proc->reg[0] = -1;
+      return;
+    }
+  }
+  int pid = args[0] == 0 ? proc->pid : args[0];
+  int suave = args[1];
+  int rigido = args[2];
+  processo_t *alvo = encontra_processo_por_pid(self, pid);
+  if (alvo == NULL || alvo->estado == ESTADO_MORTO || suave < 0 || rigido < 0 ||
+      (rigido > 0 && rigido < LIMITE_RIGIDO_MIN) ||
+      (rigido > 0 && suave > rigido))
+  {
+    console_printf("SO: limites de memória inválidos para o processo %d (%d, %d)", pid, suave, rigido);
+    proc->reg[0] = -1;
+    return;
+  }
+  alvo->limite_suave = suave;
+  alvo->limite_rigido = rigido;
+  console_printf("SO: processo %d com limites de memória %d (suave) e %d (rígido)", pid, suave, rigido);
+  so_reduz_ao_limite(self, alvo);
+  proc->reg[0] = 0;
+}
+
 // CARGA DE PROGRAMA {{{1
 
 static int so_carrega_programa_na_memoria_fisica(so_t *self, programa_t *programa)
@@ -1541,13 +3923,10 @@ static int so_carrega_programa_na_memoria_fisica(so_t *self, programa_t *program
   int end_ini = prog_end_carga(programa);
   int end_fim = end_ini + prog_tamanho(programa);
 
-  for (int end = end_ini; end < end_fim; end++)
+  if (mem_escreve_bloco(self->mem, end_ini, prog_tamanho(programa), prog_dados(programa)) != ERR_OK)
   {
-    if (mem_escreve(self->mem, end, prog_dado(programa, end)) != ERR_OK)
-    {
-      console_printf("Erro na carga da memória, endereco %d\n", end);
-      return -1;
-    }
+    console_printf("Erro na carga da memória, endereços %d-%d\n", end_ini, end_fim);
+    return -1;
   }
   console_printf("carregado na memória física, %d-%d", end_ini, end_fim);
   return end_ini;
@@ -1558,43 +3937,72 @@ static int so_carrega_programa_na_memoria_virtual(so_t *self, programa_t *progra
   int end_virt_ini = prog_end_carga(programa);
   int end_virt_fim = end_virt_ini + prog_tamanho(programa) - 1;
 
-  // carrega o programa na memória secundária
-  int end_sec = self->quadro_livre * TAM_PAGINA; // usa quadro_livre como offset na mem secundária
-
-  processo->sec_inicial = end_sec;
-  processo->sec_final = end_sec + end_virt_fim;
-
-  console_printf("SO: end_sec=%d", end_sec);
+  // reserva na memória secundária um bloco para cada página do processo
+  processo->end_virt_fim = end_virt_fim;
+  if (!so_aloca_swap_processo(self, processo, end_virt_fim / self->tam_pagina + 1))
+  {
+    return -1;
+  }
+  processo->ultima_ref = malloc(processo->n_paginas * sizeof(int));
+  if (processo->ultima_ref == NULL)
+  {
+    console_printf("SO: erro ao alocar o histórico de uso do processo %d", processo->pid);
+    return -1;
+  }
+  for (int pag = 0; pag < processo->n_paginas; pag++)
+  {
+    processo->ultima_ref[pag] = -1;
+  }
 
-  for (int end_virt = end_virt_ini; end_virt <= end_virt_fim; end_virt++)
+  // o programa não é copiado para a memória secundária: cada página é
+  //   preenchida com os dados do programa na primeira falta (ou com zeros,
+  //   se o programa só tem zeros nela), e só vai para a memória secundária
+  //   quando for gravada
+  processo->origem = malloc(processo->n_paginas * sizeof(origem_pag_t));
+  if (processo->origem == NULL)
+  {
+    console_printf("SO: erro ao alocar o mapa de páginas do processo %d", processo->pid);
+    return -1;
+  }
+  int *dados = prog_dados(programa);
+  for (int pag = 0; pag < processo->n_paginas; pag++)
   {
-    if (mem_escreve(self->mem_secundaria, end_sec, prog_dado(programa, end_virt)) != ERR_OK)
+    processo->origem[pag] = ORIGEM_ZERO;
+    for (int end = pag * self->tam_pagina; end < (pag + 1) * self->tam_pagina; end++)
     {
-      console_printf("Erro na carga da memória secundária, end %d\n", end_sec);
-      return -1;
+      if (end >= end_virt_ini && end <= end_virt_fim && dados[end - end_virt_ini] != 0)
+      {
+        processo->origem[pag] = ORIGEM_PROGRAMA;
+        break;
+      }
     }
-    console_printf("v[%d]=sec[%d]=%d", end_virt, end_sec, prog_dado(programa, end_virt));
-    end_sec++;
   }
 
-  // atualiza o próximo quadro livre na memória secundária
-  self->quadro_livre += (end_virt_fim - end_virt_ini + TAM_PAGINA) / TAM_PAGINA;
-
-  console_printf("programa carregado na memória secundária, V%d-%d\n",
+  console_printf("programa mapeado na memória virtual, V%d-%d\n",
                  end_virt_ini, end_virt_fim);
 
-  escreve_memoria_secundaria(self);
   return end_virt_ini;
 }
 
 // carrega o programa na memória de um processo ou na memória física se NENHUM_PROCESSO
+// o programa de um processo vem da cache de imagens, e o processo usa a
+//   imagem até morrer (ver so_libera_swap_processo)
 // retorna o endereço de carga ou -1
 static int so_carrega_programa(so_t *self, processo_t *processo,
                                char *nome_do_executavel)
 {
   console_printf("SO: carga de '%s'", nome_do_executavel);
 
-  programa_t *programa = prog_cria(nome_do_executavel);
+  programa_t *programa;
+  if (processo == NENHUM_PROCESSO)
+  {
+    programa = prog_cria(nome_do_executavel);
+  }
+  else
+  {
+    processo->imagem = cache_imagens_obtem(self->imagens, nome_do_executavel);
+    programa = processo->imagem == NULL ? NULL : imagem_programa(processo->imagem);
+  }
   if (programa == NULL)
   {
     console_printf("Erro na leitura do programa '%s'\n", nome_do_executavel);
@@ -1605,13 +4013,12 @@ static int so_carrega_programa(so_t *self, processo_t *processo,
   if (processo == NENHUM_PROCESSO)
   {
     end_carga = so_carrega_programa_na_memoria_fisica(self, programa);
+    prog_destroi(programa);
   }
   else
   {
     end_carga = so_carrega_programa_na_memoria_virtual(self, programa, processo);
   }
-
-  prog_destroi(programa);
   return end_carga;
 }
 
@@ -1621,35 +4028,70 @@ static int so_carrega_programa(so_t *self, processo_t *processo,
 // retorna false se erro (string maior que vetor, valor não char na memória,
 //   erro de acesso à memória)
 // O endereço é um endereço virtual de um processo.
-static bool so_copia_str_do_processo(so_t *self, int tam, char str[tam],
-                                     int end_virt, processo_t *processo)
+// lê um valor da memória do processo, no endereço virtual 'end_virt'
+// se a página está ausente, pede a página e retorna ERR_PAG_AUSENTE; o
+//   processo refaz a chamada de sistema quando a página chegar
+static err_t so_le_do_processo(so_t *self, int end_virt, int *pvalor, processo_t *processo)
 {
   if (processo == NENHUM_PROCESSO)
   {
-    return false;
+    return ERR_END_INV;
   }
 
   mmu_define_tabpag(self->mmu, processo->tabpag);
+  mmu_define_pid(self->mmu, processo->pid);
 
-  for (int indice_str = 0; indice_str < tam; indice_str++)
+  err_t err = mmu_le(self->mmu, end_virt, pvalor, usuario);
+
+  if (err == ERR_PAG_AUSENTE)
   {
-    int caractere;
+    // salva o endereço que causou o page fault
+    self->processo_corrente->complemento = end_virt;
+    // pede a página ao disco; o processo bloqueia e, quando for
+    //   desbloqueado, executa de novo a instrução CHAMAS (que já tinha
+    //   avançado o PC), refazendo a chamada de sistema
+    so_trata_pag_ausente(self);
+    processo->pc--;
+  }
+  return err;
+}
+
+// escreve um valor na memória do processo, no endereço virtual 'end_virt'
+// se a página está ausente ou é compartilhada, trata como a interrupção de
+//   erro da CPU trataria, e retorna o erro; o processo refaz a chamada de
+//   sistema quando puder escrever
+static err_t so_escreve_no_processo(so_t *self, int end_virt, int valor, processo_t *processo)
+{
+  if (processo == NENHUM_PROCESSO)
+  {
+    return ERR_END_INV;
+  }
+
+  mmu_define_tabpag(self->mmu, processo->tabpag);
+  mmu_define_pid(self->mmu, processo->pid);
 
-    err_t err = mmu_le(self->mmu, end_virt + indice_str, &caractere, usuario);
+  err_t err = mmu_escreve(self->mmu, end_virt, valor, usuario);
 
+  if (err == ERR_PAG_AUSENTE || err == ERR_PAG_PROTEGIDA)
+  {
+    self->processo_corrente->complemento = end_virt;
     if (err == ERR_PAG_AUSENTE)
-    {
-      // salva o endereço que causou o page fault
-      self->processo_corrente->complemento = end_virt + indice_str;
-      // trata a falta de página
       so_trata_pag_ausente(self);
-      // tenta ler novamente
-      if (mmu_le(self->mmu, end_virt + indice_str, &caractere, usuario) != ERR_OK)
-      {
-        return false;
-      }
-    }
-    else if (err != ERR_OK)
+    else
+      so_trata_pag_protegida(self);
+    processo->pc--;
+  }
+  return err;
+}
+
+static bool so_copia_str_do_processo(so_t *self, int tam, char str[tam],
+                                     int end_virt, processo_t *processo)
+{
+  for (int indice_str = 0; indice_str < tam; indice_str++)
+  {
+    int caractere;
+
+    if (so_le_do_processo(self, end_virt + indice_str, &caractere, processo) != ERR_OK)
     {
       return false;
     }
@@ -1670,4 +4112,97 @@ static bool so_copia_str_do_processo(so_t *self, int tam, char str[tam],
   return false;
 }
 
+// INSTANTÂNEO DA MEMÓRIA {{{1
+
+// grava 'n' estruturas de tamanho 'tam'; retorna false em caso de erro
+static bool so_grava(FILE *arq, void *dados, int tam, int n)
+{
+  return fwrite(dados, tam, n, arq) == n;
+}
+
+bool so_grava_instantaneo(so_t *self, char *nome)
+{
+  FILE *arq = fopen(nome, "wb");
+  if (arq == NULL)
+  {
+    console_printf("SO: não consigo criar o instantâneo '%s'", nome);
+    return false;
+  }
+
+  instantaneo_cab_t cab = {
+      .magico = INSTANTANEO_MAGICO,
+      .versao = INSTANTANEO_VERSAO,
+      .agora = tempo_atual(self),
+      .tam_pagina = self->tam_pagina,
+      .tam_mem = mem_tam(self->mem),
+      .n_quadros = self->n_quadros,
+      .primeiro_quadro = self->quadros->primeiro,
+      .n_procs = self->n_procs,
+      .n_fila = so_troca(self)->usa_fifo ? fifo_num_pags(self->fifo) : 0,
+  };
+  bool ok = so_grava(arq, &cab, sizeof(cab), 1);
+
+  // memória principal
+  int *conteudo = malloc(cab.tam_mem * sizeof(int));
+  ok = ok && conteudo != NULL && mem_le_bloco(self->mem, 0, cab.tam_mem, conteudo) == ERR_OK;
+  ok = ok && so_grava(arq, conteudo, sizeof(int), cab.tam_mem);
+  free(conteudo);
+
+  // tabela de quadros
+  for (int quadro = 0; ok && quadro < self->n_quadros; quadro++)
+  {
+    quadro_t *q = tabquadros_quadro(self->quadros, quadro);
+    instantaneo_quadro_t iq = {
+        .ocupado = q->ocupado,
+        .pid = q->ocupado ? q->processo->pid : 0,
+        .pagina = q->ocupado ? q->pagina : -1,
+    };
+    ok = so_grava(arq, &iq, sizeof(iq), 1);
+  }
+
+  // processos e suas tabelas de páginas
+  for (int i = 0; ok && i < self->n_procs; i++)
+  {
+    processo_t *proc = self->processos[i];
+    instantaneo_proc_t ip = {
+        .pid = proc->pid,
+        .estado = proc->estado,
+        .pc = proc->pc,
+        .n_paginas = proc->n_paginas,
+    };
+    ok = so_grava(arq, &ip, sizeof(ip), 1);
+    for (int pag = 0; ok && pag < proc->n_paginas; pag++)
+    {
+      instantaneo_pagina_t ipag = {
+          .quadro = -1,
+          .acessada = tabpag_bit_acesso(proc->tabpag, pag),
+          .alterada = tabpag_bit_alteracao(proc->tabpag, pag),
+          .bloco_swap = proc->blocos_swap[pag],
+          .origem = proc->origem[pag],
+      };
+      tabpag_traduz(proc->tabpag, pag, &ipag.quadro);
+      ok = so_grava(arq, &ipag, sizeof(ipag), 1);
+    }
+  }
+
+  // fila de páginas
+  for (pagina_t *p = self->fifo->head; ok && cab.n_fila > 0 && p != NULL; p = p->next)
+  {
+    instantaneo_fila_t ifila = {
+        .pid = p->processo->pid,
+        .pagina = p->num,
+        .quadro = p->quadro_num,
+    };
+    ok = so_grava(arq, &ifila, sizeof(ifila), 1);
+  }
+
+  if (fclose(arq) != 0)
+    ok = false;
+  if (ok)
+    console_printf("SO: instantâneo da memória gravado em '%s'", nome);
+  else
+    console_printf("SO: erro ao gravar o instantâneo '%s'", nome);
+  return ok;
+}
+
 // vim: foldmethod=marker
\ No newline at end of file
@@ -12,8 +12,25 @@
 #include "es.h"
 #include "console.h" // só para uma gambiarra
 #include "fifo.h"
-
-#define QTD_IRQ 6 // quantidade de interrupções
+#include "swap.h"
+#include "quadros.h"
+#include "fila_disco.h"
+#include "imagens.h"
+#include "zswap.h"
+#include "geometria.h"
+#include "histograma.h"
+
+#define QTD_IRQ N_IRQ // quantidade de interrupções
+
+// histograma da latência dos pedidos ao disco: a faixa i conta as latências
+//   menores que LATENCIA_BASE << i, a última conta as demais
+#define N_FAIXAS_LATENCIA 8
+#define LATENCIA_BASE 32
+
+// número de terminais, e de caracteres que o SO guarda para escrever na tela
+//   de cada um (ver SO_ESCR_STR) e dos digitados em cada um (ver SO_LE_LINHA)
+#define N_TERMINAIS 4
+#define TAM_BUF_TELA 64
 
 typedef struct so_t so_t;
 
@@ -23,19 +40,40 @@ typedef enum
     ESTADO_PRONTO,
     ESTADO_BLOQUEADO,
     ESTADO_MORTO,
+    // retirado da memória pelo escalonador de médio prazo
+    ESTADO_SUSPENSO,
     ESTADO_N
 } estado_processo_t;
 
 typedef enum
 {
     R_BLOQ_LEITURA,
+    // esperando uma linha completa no buffer do teclado, para continuar um
+    //   SO_LE_LINHA
+    R_BLOQ_LEITURA_LINHA,
     R_BLOQ_ESCRITA,
+    // esperando espaço no buffer da tela, para continuar um SO_ESCR_STR
+    R_BLOQ_ESCRITA_STR,
     R_BLOQ_ESPERA_PROC,
     R_BLOQ_ESPERA_DISCO,
+    // esperando o disco liberar um quadro, para refazer uma falta de página
+    R_BLOQ_ESPERA_QUADRO,
     R_PROC_BLOQ,
 
 } motivo_bloq_processo_t;
 
+// onde está o conteúdo de uma página quando ela não está na memória principal
+// as páginas começam no programa (ou zeradas, se o programa só tem zeros
+//   nelas), e passam para a memória secundária na primeira vez em que são
+//   gravadas; enquanto não são alteradas, podem sair da memória principal
+//   sem ser gravadas e voltar do programa
+typedef enum
+{
+    ORIGEM_SWAP,
+    ORIGEM_PROGRAMA,
+    ORIGEM_ZERO,
+} origem_pag_t;
+
 typedef struct metricas_estado_processo_t metricas_estado_processo_t;
 typedef struct processo_metricas_t processo_metricas_t;
 typedef struct processo_t processo_t;
@@ -47,6 +85,85 @@ typedef struct
     int tempo_total_ocioso;
     int num_interrupcoes[QTD_IRQ];
     int num_preempcoes;
+    int num_suspensoes;
+    int num_retomadas;
+    // pedidos de transferência de páginas feitos ao disco, e cancelados
+    int num_leituras_disco;
+    int num_gravacoes_disco;
+    int num_cancelamentos_disco;
+    // páginas trazidas por leitura antecipada, e quantas delas foram usadas
+    //   ou saíram da memória sem ser usadas
+    int num_antecipadas;
+    int num_antecipadas_usadas;
+    int num_antecipadas_perdidas;
+    // daemon de paginação: quadros liberados, e quantos deles tinham páginas
+    //   alteradas que precisaram ser gravadas
+    int num_liberados_daemon;
+    int num_limpezas_daemon;
+    // faltas de página que precisaram gravar a vítima antes de ler a página,
+    //   e páginas que faltaram enquanto eram gravadas e voltaram sem leitura
+    int num_faltas_com_gravacao;
+    int num_resgates;
+    // faltas de página atendidas com o conteúdo do programa ou com zeros,
+    //   sem ler o disco
+    int num_preenchidas_programa;
+    int num_preenchidas_zero;
+    // páginas mapeadas em um quadro que outro processo já usava (do mesmo
+    //   programa, ou do pai em um SO_FORK), e escritas em páginas
+    //   compartilhadas: com cópia para um quadro novo, ou sem cópia, quando
+    //   o processo era o único a usar o quadro
+    int num_compartilhadas;
+    int num_copias_escrita;
+    int num_escritas_sem_copia;
+    // processos criados por SO_FORK
+    int num_forks;
+    // mesclagem de páginas iguais: quadros examinados, páginas que passaram
+    //   a usar o quadro de outra igual, e escritas em quadros mesclados
+    int num_examinados_mescla;
+    int num_mescladas;
+    int num_desfeitas_mescla;
+    // páginas grandes: blocos de quadros reservados, reservas desfeitas
+    //   porque outro quadro precisou de um dos quadros, e promoções
+    int num_reservas_grandes;
+    int num_reservas_desfeitas;
+    int num_promocoes;
+    // páginas grandes que existiam quando o processo morreu ou foi suspenso
+    //   (são desfeitas, mas não por uso das páginas)
+    int num_grandes_liberadas;
+    // faltas de página atendidas com substituição local (processo no limite
+    //   de memória), e quadros liberados pelo daemon de processos acima do
+    //   limite suave
+    int num_substituicoes_locais;
+    int num_liberados_limite;
+    // soma, a cada interrupção do relógio, dos descritores válidos e das
+    //   páginas mapeadas nas tabelas de páginas dos processos
+    int soma_descritores;
+    int soma_mapeadas;
+    int n_amostras_tabelas;
+    // latência dos pedidos ao disco (da chegada na fila até a conclusão),
+    //   das leituras [0] e das gravações [1]
+    int latencia_disco[2][N_FAIXAS_LATENCIA];
+    int latencia_disco_total[2];
+    int latencia_disco_max[2];
+    // soma das distâncias percorridas pela cabeça do disco
+    int deslocamento_disco;
+    // chamadas SO_ESCR_STR, e caracteres escritos por elas
+    int num_escritas_str;
+    int num_caracteres_str;
+    // chamadas SO_LE_LINHA, e caracteres lidos por elas
+    int num_leituras_linha;
+    int num_caracteres_linha;
+    // latência das faltas de página, em instruções, da falta até o processo
+    //   voltar a executar: de todas, das menores (atendidas sem esperar o
+    //   disco), das maiores, e das que precisaram gravar a vítima; espera
+    //   dos pedidos das faltas na fila do disco, e tempo do hospedeiro (em
+    //   ns) gasto pelo SO no tratamento das faltas
+    histograma_t latencia_faltas;
+    histograma_t latencia_faltas_menores;
+    histograma_t latencia_faltas_maiores;
+    histograma_t latencia_faltas_gravacao;
+    histograma_t espera_fila_faltas;
+    histograma_t ns_faltas;
 } so_metricas_t;
 
 struct metricas_estado_processo_t
@@ -62,6 +179,16 @@ struct processo_metricas_t
     int tempo_retorno;
     int tempo_resposta;
     int qtd_page_fault;
+    int qtd_suspensoes;
+    int maior_conj_trabalho;
+    int maior_pff;
+    // maior conjunto residente (quadros com páginas do processo)
+    int maior_rss;
+    // faltas de página do processo: latência em instruções, tempo do
+    //   hospedeiro gasto pelo SO (em ns), e quantas esperaram o disco
+    histograma_t latencia_faltas;
+    histograma_t ns_faltas;
+    int qtd_faltas_maiores;
 
     metricas_estado_processo_t estados[ESTADO_N];
 };
@@ -86,12 +213,82 @@ struct processo_t
     processo_metricas_t metricas;
 
     tabpag_t *tabpag;
-    int sec_inicial;
-    int sec_final;
-    int hora_desbloqueio;
+    // último endereço virtual válido do processo
+    int end_virt_fim;
+    // mapa de blocos no espaço de troca: o conteúdo da página i está no
+    //   bloco blocos_swap[i] da memória secundária
+    int n_paginas;
+    int *blocos_swap;
+    // origem do conteúdo de cada página, e a imagem do programa de onde vêm
+    //   as páginas com origem no programa
+    origem_pag_t *origem;
+    imagem_t *imagem;
+
+    // instante da última referência a cada página (-1 se nunca usada), para
+    //   estimar o conjunto de trabalho
+    int *ultima_ref;
+    // tamanho do conjunto de trabalho na última estimativa
+    int conj_trabalho;
+    // faltas de página na janela corrente, e na última janela completa (PFF)
+    int faltas_janela;
+    int pff;
+    // instante em que foi suspenso pelo escalonador de médio prazo
+    int hora_suspensao;
+    // leitura antecipada: página cuja falta continua a sequência de faltas
+    //   do processo, e número de páginas a ler além da que faltou
+    int prox_pag_seq;
+    int janela_antecipacao;
+    // limites do conjunto residente (0 se não tem), ver SO_LIMITA_MEM
+    int limite_suave;
+    int limite_rigido;
+    // falta de página esperando o processo voltar a executar, para as
+    //   métricas (inicio_falta -1 se não há): instante da falta, se o
+    //   processo esperou o disco e se a vítima foi gravada, e tempo dos
+    //   pedidos da falta na fila do disco
+    int inicio_falta;
+    bool falta_maior;
+    bool falta_com_gravacao;
+    int espera_fila_falta;
+    // a falta vai ser refeita depois de o processo esperar um quadro, e não
+    //   é contada de novo
+    bool refaz_falta;
+    // caracteres de um SO_ESCR_STR já colocados no buffer da tela, quando a
+    //   chamada vai ser refeita (o buffer encheu ou faltou uma página)
+    int escr_feitos;
+    // caracteres de um SO_LE_LINHA já copiados para a memória do processo, e
+    //   o máximo pedido, quando a chamada vai ser refeita (o buffer do
+    //   teclado esvaziou ou faltou uma página)
+    int le_feitos;
+    int le_max;
 };
 
 #define NENHUM_PROCESSO NULL
+
+// transferência com o disco em andamento em um quadro (reservado na tabela
+//   de quadros); os pedidos ao disco têm como etiqueta o número do quadro
+typedef struct
+{
+    // a página que estava no quadro está sendo gravada, o processo dono e o
+    //   número da página
+    bool gravando;
+    processo_t *proc_gravacao;
+    int pag_gravacao;
+    // processo e página a ler para o quadro, depois da gravação se houver
+    //   (processo NULL se não há leitura, ou se o processo morreu)
+    processo_t *proc_leitura;
+    int pag_leitura;
+    // a página é lida antecipadamente (o processo não precisa dela ainda)
+    bool antecipada;
+    // a página do programa vai ser alterada, e não é compartilhada
+    bool privada;
+    // quadro compartilhado de onde a página é copiada, em vez de vir da
+    //   memória secundária ou do programa (-1 se não é cópia)
+    int quadro_copia;
+    // número de quadros transferidos pelo pedido (0 nos quadros que fazem
+    //   parte do pedido de um quadro anterior)
+    int n_quadros;
+} transito_t;
+
 typedef struct no_fila_t
 {
     processo_t *processo;
@@ -104,6 +301,15 @@ typedef struct
     no_fila_t *fim;
 } fila_t;
 
+// caracteres esperando para ser escritos na tela de um terminal, ou
+//   digitados no terminal e ainda não lidos, em uma fila circular
+typedef struct
+{
+    int car[TAM_BUF_TELA];
+    int inicio;
+    int n;
+} buf_tela_t;
+
 struct so_t
 {
     cpu_t *cpu;
@@ -126,16 +332,70 @@ struct so_t
 
     int r_agora;
 
-    int quadro_livre;
-    int quadro_livre_primaria;
+    // tamanho de uma página, e número de quadros da memória principal
+    int tam_pagina;
+    int n_quadros;
+    // número de páginas em uma página grande (0 se não são usadas)
+    int paginas_grandes;
+
+    swap_t *swap;
+    // páginas comprimidas que não foram para a memória secundária
+    zswap_t *zswap;
+    tabquadros_t *quadros;
+    // algoritmo de substituição de páginas em uso
+    int algoritmo_troca;
+    // próximo quadro a ser examinado pelo mesclador de páginas iguais
+    int ponteiro_mescla;
+    // interrupções do relógio desde o início da janela de medição corrente
+    int tiques_janela;
 
     fifo_t *fifo;
 
-    int hora_disco_livre;
+    // transferências com o disco, uma por quadro
+    transito_t *transitos;
+    // pedidos ao disco esperando, e o pedido sendo atendido (o SO entrega um
+    //   de cada vez ao disco, para poder escolher a ordem)
+    fila_disco_t *fila_disco;
+    // imagens dos programas executados pelos processos
+    cache_imagens_t *imagens;
+    int escalonador_disco;
+    bool disco_ocupado;
+    pedido_disco_t disco_atual;
+    // saída dos terminais que ainda não foi para a tela
+    buf_tela_t telas[N_TERMINAIS];
+    // entrada dos terminais que ainda não foi lida pelos processos
+    buf_tela_t teclados[N_TERMINAIS];
 };
-so_t *so_cria(cpu_t *cpu, mem_t *mem, mem_t *mem_sec, mmu_t *mmu, es_t *es, console_t *console);
+// confere se a geometria (já conferida com geometria_confere) serve para o
+//   SO: os quadros da memória principal devem bastar para o SO, para a
+//   reserva de páginas comprimidas e para as páginas de uma instrução
+// retorna NULL se ela serve, ou uma mensagem explicando o problema
+char *so_confere_geometria(geometria_t *geometria);
+
+// 'geometria' tem o tamanho da página e o número de quadros da memória
+//   principal que o SO pode usar
+// retorna NULL se a geometria não serve (ver so_confere_geometria)
+so_t *so_cria(cpu_t *cpu, mem_t *mem, mem_t *mem_sec, mmu_t *mmu, es_t *es, console_t *console,
+              geometria_t *geometria);
 void so_destroi(so_t *self);
 
+// escolhe o algoritmo de substituição de páginas pelo nome: "fifo",
+//   "segunda_chance", "clock", "wsclock", "envelhecimento", "nfu" ou "lfu"
+// deve ser chamada antes do início da execução
+// retorna false se o nome não corresponde a nenhum algoritmo
+bool so_define_troca(so_t *self, char *nome);
+
+// escolhe o escalonamento dos pedidos ao disco pelo nome: "fcfs", "sstf",
+//   "scan", "clook" ou "deadline"
+// retorna false se o nome não corresponde a nenhuma política
+bool so_define_escalonador_disco(so_t *self, char *nome);
+
+// grava no arquivo 'nome' um instantâneo binário da memória principal, da
+//   tabela de quadros, das tabelas de páginas dos processos e da fila de
+//   páginas (formato em instantaneo.h, ver o programa mostra_instantaneo)
+// retorna false em caso de erro
+bool so_grava_instantaneo(so_t *self, char *nome);
+
 // Chamadas de sistema
 // Uma chamada de sistema é realizada colocando a identificação da
 //   chamada (um dos valores abaixo) no registrador A e executando a
@@ -158,6 +418,24 @@ void so_destroi(so_t *self);
 // retorna em A: 0 se OK ou um código de erro negativo
 #define SO_ESCR 2
 
+// escreve vários caracteres no dispositivo de saída do processo
+// recebe em X o endereço de 2 valores na memória do processo chamador: o
+//   endereço do primeiro caractere e o número de caracteres
+// os caracteres são copiados para um buffer do SO, que os escreve na tela
+//   quando ela está pronta; o processo só bloqueia se o buffer encher
+// retorna em A: o número de caracteres escritos ou um código de erro
+//   negativo
+#define SO_ESCR_STR 12
+
+// lê uma linha do dispositivo de entrada do processo
+// recebe em X o endereço de 2 valores na memória do processo chamador: o
+//   endereço onde colocar os caracteres e o número máximo de caracteres
+// o SO guarda em um buffer os caracteres digitados; a leitura termina com
+//   o '\n' (que é colocado na memória) ou com o número máximo de caracteres,
+//   e o processo só é desbloqueado quando houver uma linha completa
+// retorna em A: o número de caracteres lidos ou um código de erro negativo
+#define SO_LE_LINHA 13
+
 // #define SO_ABRE        3
 // #define SO_FECHA       4
 // #define SO_SEL_LE      5
@@ -193,4 +471,24 @@ void so_destroi(so_t *self);
 // retorna sem bloquear, com erro, se não existir processo com esse pid
 #define SO_ESPERA_PROC 9
 
+// cria um processo filho, cópia do processo que realiza esta chamada
+// o filho executa o mesmo programa, a partir da instrução seguinte à
+//   chamada, com os mesmos valores na memória e no registrador X; a memória
+//   não é copiada na criação: as páginas ficam compartilhadas entre os dois
+//   processos, e uma página só é copiada quando um deles escreve nela
+// retorna em A: no pai, o pid do filho ou um código de erro negativo; no
+//   filho, 0
+#define SO_FORK 10
+
+// limita o número de quadros da memória principal com páginas de um
+//   processo (conjunto residente)
+// recebe em X o endereço de 3 valores na memória do processo chamador: o
+//   pid do processo a limitar (0 para o chamador), o limite suave e o
+//   limite rígido (0 para não limitar)
+// acima do limite suave, o processo substitui as próprias páginas quando
+//   falta memória; no limite rígido, sempre; os processos criados por um
+//   processo herdam os limites dele
+// retorna em A: 0 se OK ou um código de erro negativo
+#define SO_LIMITA_MEM 11
+
 #endif // SO_H
@@ -0,0 +1,213 @@
+// swap.c
+// alocador do espaço de troca na memória secundária
+// simulador de computador
+// so24b
+
+#include "swap.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+
+#define BITS_POR_PALAVRA 32
+
+struct swap_t
+{
+  // número de blocos gerenciados
+  int n_blocos;
+  // mapa de bits, 1 bit por bloco (1 se ocupado)
+  uint32_t *mapa;
+  int n_palavras;
+  // número de usuários de cada bloco (0 se livre)
+  int *usos;
+  // número de blocos ocupados
+  int n_ocupados;
+  // estatísticas
+  int pico_uso;
+  int falhas_contiguo;
+  // palavra onde começa a próxima busca por bloco livre
+  int dica;
+};
+
+swap_t *swap_cria(int n_blocos)
+{
+  swap_t *self = malloc(sizeof(*self));
+  assert(self != NULL);
+  self->n_blocos = n_blocos;
+  self->n_palavras = (n_blocos + BITS_POR_PALAVRA - 1) / BITS_POR_PALAVRA;
+  self->mapa = calloc(self->n_palavras, sizeof(*self->mapa));
+  assert(self->mapa != NULL);
+  self->usos = calloc(n_blocos, sizeof(*self->usos));
+  assert(self->usos != NULL);
+  // os bits da última palavra que não correspondem a blocos ficam ocupados,
+  //   para não serem encontrados pela busca
+  int sobra = self->n_palavras * BITS_POR_PALAVRA - n_blocos;
+  for (int i = 0; i < sobra; i++)
+  {
+    self->mapa[self->n_palavras - 1] |= 1u << (BITS_POR_PALAVRA - 1 - i);
+  }
+  self->n_ocupados = 0;
+  self->pico_uso = 0;
+  self->falhas_contiguo = 0;
+  self->dica = 0;
+  return self;
+}
+
+void swap_destroi(swap_t *self)
+{
+  if (self != NULL)
+  {
+    free(self->mapa);
+    free(self->usos);
+    free(self);
+  }
+}
+
+bool swap_ocupado(swap_t *self, int bloco)
+{
+  if (bloco < 0 || bloco >= self->n_blocos)
+    return false;
+  return (self->mapa[bloco / BITS_POR_PALAVRA] >> (bloco % BITS_POR_PALAVRA)) & 1u;
+}
+
+static void swap__marca(swap_t *self, int bloco)
+{
+  self->mapa[bloco / BITS_POR_PALAVRA] |= 1u << (bloco % BITS_POR_PALAVRA);
+  self->usos[bloco] = 1;
+  self->n_ocupados++;
+  if (self->n_ocupados > self->pico_uso)
+    self->pico_uso = self->n_ocupados;
+}
+
+int swap_aloca(swap_t *self)
+{
+  // procura uma palavra com algum bit livre a partir da dica, dando a volta
+  for (int n = 0; n < self->n_palavras; n++)
+  {
+    int p = (self->dica + n) % self->n_palavras;
+    uint32_t livres = ~self->mapa[p];
+    if (livres != 0)
+    {
+      int bloco = p * BITS_POR_PALAVRA + __builtin_ctz(livres);
+      swap__marca(self, bloco);
+      self->dica = p;
+      return bloco;
+    }
+  }
+  return -1;
+}
+
+int swap_aloca_contiguo(swap_t *self, int n)
+{
+  if (n <= 0 || n > self->n_blocos - self->n_ocupados)
+    return -1;
+  int inicio = 0;
+  int tam = 0;
+  for (int bloco = 0; bloco < self->n_blocos; bloco++)
+  {
+    // pula palavras inteiramente ocupadas
+    if (bloco % BITS_POR_PALAVRA == 0 && self->mapa[bloco / BITS_POR_PALAVRA] == UINT32_MAX)
+    {
+      tam = 0;
+      bloco += BITS_POR_PALAVRA - 1;
+      continue;
+    }
+    if (swap_ocupado(self, bloco))
+    {
+      tam = 0;
+      continue;
+    }
+    if (tam == 0)
+      inicio = bloco;
+    tam++;
+    if (tam == n)
+    {
+      for (int b = inicio; b < inicio + n; b++)
+        swap__marca(self, b);
+      return inicio;
+    }
+  }
+  self->falhas_contiguo++;
+  return -1;
+}
+
+void swap_libera(swap_t *self, int bloco)
+{
+  if (!swap_ocupado(self, bloco))
+    return;
+  if (--self->usos[bloco] > 0)
+    return;
+  self->mapa[bloco / BITS_POR_PALAVRA] &= ~(1u << (bloco % BITS_POR_PALAVRA));
+  self->n_ocupados--;
+  if (bloco / BITS_POR_PALAVRA < self->dica)
+    self->dica = bloco / BITS_POR_PALAVRA;
+}
+
+void swap_compartilha(swap_t *self, int bloco)
+{
+  if (swap_ocupado(self, bloco))
+    self->usos[bloco]++;
+}
+
+int swap_n_usos(swap_t *self, int bloco)
+{
+  if (!swap_ocupado(self, bloco))
+    return 0;
+  return self->usos[bloco];
+}
+
+// ESTATÍSTICAS
+
+int swap_n_blocos(swap_t *self)
+{
+  return self->n_blocos;
+}
+
+int swap_n_livres(swap_t *self)
+{
+  return self->n_blocos - self->n_ocupados;
+}
+
+int swap_pico_uso(swap_t *self)
+{
+  return self->pico_uso;
+}
+
+int swap_falhas_contiguo(swap_t *self)
+{
+  return self->falhas_contiguo;
+}
+
+int swap_n_extensoes_livres(swap_t *self)
+{
+  int n = 0;
+  bool anterior_livre = false;
+  for (int bloco = 0; bloco < self->n_blocos; bloco++)
+  {
+    bool livre = !swap_ocupado(self, bloco);
+    if (livre && !anterior_livre)
+      n++;
+    anterior_livre = livre;
+  }
+  return n;
+}
+
+int swap_maior_extensao_livre(swap_t *self)
+{
+  int maior = 0;
+  int tam = 0;
+  for (int bloco = 0; bloco < self->n_blocos; bloco++)
+  {
+    if (swap_ocupado(self, bloco))
+    {
+      tam = 0;
+    }
+    else
+    {
+      tam++;
+      if (tam > maior)
+        maior = tam;
+    }
+  }
+  return maior;
+}
@@ -0,0 +1,74 @@
+// swap.h
+// alocador do espaço de troca na memória secundária
+// simulador de computador
+// so24b
+
+#ifndef SWAP_H
+#define SWAP_H
+
+// gerencia a memória secundária como um conjunto de blocos do tamanho de uma
+//   página, controlados por um mapa de bits (1 bit por bloco)
+// cada processo recebe um bloco por página do seu espaço de endereçamento,
+//   de preferência contíguos; os blocos são devolvidos quando o processo
+//   morre, para serem reaproveitados por processos criados depois
+// um bloco pode ser compartilhado por mais de um processo (depois de um
+//   SO_FORK); cada bloco conta quantos o usam, e só fica livre quando todos
+//   o liberarem
+// mantém estatísticas de uso e de fragmentação do espaço livre
+
+#include <stdbool.h>
+
+// tipo opaco que representa o espaço de troca
+typedef struct swap_t swap_t;
+
+// cria um espaço de troca com 'n_blocos' blocos, todos livres
+// mata o programa em caso de erro (malloc)
+swap_t *swap_cria(int n_blocos);
+
+// destrói o espaço de troca
+void swap_destroi(swap_t *self);
+
+// aloca um bloco livre qualquer
+// retorna o número do bloco, ou -1 se não houver bloco livre
+int swap_aloca(swap_t *self);
+
+// aloca 'n' blocos livres consecutivos (first-fit)
+// retorna o número do primeiro bloco, ou -1 se não houver uma sequência
+//   livre desse tamanho (pode haver blocos livres não contíguos)
+int swap_aloca_contiguo(swap_t *self, int n);
+
+// libera o bloco 'bloco'; não faz nada se o bloco já está livre
+// se o bloco é compartilhado, só diminui o número de usuários
+void swap_libera(swap_t *self, int bloco);
+
+// registra mais um usuário do bloco ocupado 'bloco'
+void swap_compartilha(swap_t *self, int bloco);
+
+// retorna o número de usuários do bloco (0 se está livre)
+int swap_n_usos(swap_t *self, int bloco);
+
+// retorna true se o bloco está alocado
+bool swap_ocupado(swap_t *self, int bloco);
+
+// ESTATÍSTICAS
+
+// número total de blocos
+int swap_n_blocos(swap_t *self);
+
+// número de blocos livres
+int swap_n_livres(swap_t *self);
+
+// maior número de blocos ocupados ao mesmo tempo
+int swap_pico_uso(swap_t *self);
+
+// número de sequências (extensões) de blocos livres
+int swap_n_extensoes_livres(swap_t *self);
+
+// tamanho da maior extensão de blocos livres
+int swap_maior_extensao_livre(swap_t *self);
+
+// número de alocações contíguas que não foram possíveis por causa da
+//   fragmentação (havia blocos livres suficientes, mas não consecutivos)
+int swap_falhas_contiguo(swap_t *self);
+
+#endif // SWAP_H
@@ -10,12 +10,16 @@
 
 // estrutura auxiliar, contém informação sobre uma página
 
-tabpag_t *tabpag_cria(void)
+tabpag_t *tabpag_cria(int tam_grande)
 {
   tabpag_t *self = malloc(sizeof(*self));
   assert(self != NULL);
   self->tam_tab = 0;
   self->tabela = NULL;
+  self->tam_grande = tam_grande;
+  self->n_grandes = 0;
+  self->grandes = NULL;
+  self->n_rebaixamentos = 0;
   return self;
 }
 
@@ -25,11 +29,23 @@ void tabpag_destroi(tabpag_t *self)
   {
     if (self->tabela != NULL)
       free(self->tabela);
+    free(self->grandes);
     free(self);
   }
 }
 
-// retorna true se a página for válida (pode ser traduzida em um quadro)
+// retorna o descritor da página grande que contém a página, ou NULL
+static descritor_t *tabpag__grande(tabpag_t *self, int pagina)
+{
+  if (self->tam_grande == 0 || pagina < 0)
+    return NULL;
+  int g = pagina / self->tam_grande;
+  if (g >= self->n_grandes || !self->grandes[g].valida)
+    return NULL;
+  return &self->grandes[g];
+}
+
+// retorna true se a página tem descritor válido na tabela
 static bool tabpag__pagina_valida(tabpag_t *self, int pagina)
 {
   if (pagina < 0 || pagina >= self->tam_tab)
@@ -37,8 +53,38 @@ static bool tabpag__pagina_valida(tabpag_t *self, int pagina)
   return self->tabela[pagina].valida;
 }
 
+// retorna o descritor que mapeia a página (o da página grande que a
+//   contém, se houver), ou NULL se a página for inválida
+static descritor_t *tabpag__descritor(tabpag_t *self, int pagina)
+{
+  descritor_t *g = tabpag__grande(self, pagina);
+  if (g != NULL)
+    return g;
+  if (!tabpag__pagina_valida(self, pagina))
+    return NULL;
+  return &self->tabela[pagina];
+}
+
+// desfaz a página grande que contém a página, se houver: cada página volta
+//   a ter seu descritor, com os bits da página grande
+static void tabpag__rebaixa(tabpag_t *self, int pagina)
+{
+  descritor_t *g = tabpag__grande(self, pagina);
+  if (g == NULL)
+    return;
+  int primeira = pagina - pagina % self->tam_grande;
+  for (int i = 0; i < self->tam_grande; i++)
+  {
+    self->tabela[primeira + i] = *g;
+    self->tabela[primeira + i].quadro = g->quadro + i;
+  }
+  g->valida = false;
+  self->n_rebaixamentos++;
+}
+
 void tabpag_invalida_pagina(tabpag_t *self, int pagina)
 {
+  tabpag__rebaixa(self, pagina);
   // página já é inválida -- não faz nada
   if (!tabpag__pagina_valida(self, pagina))
     return;
@@ -49,10 +95,13 @@ void tabpag_invalida_pagina(tabpag_t *self, int pagina)
     return;
   }
   // última página na tabela -- reduz a tabela até que a última seja válida
+  //   (ou esteja em uma página grande, que precisa dos descritores quando
+  //   for desfeita)
   do
   {
     self->tam_tab--;
-  } while (self->tam_tab > 0 && !self->tabela[self->tam_tab - 1].valida);
+  } while (self->tam_tab > 0 && !self->tabela[self->tam_tab - 1].valida &&
+           tabpag__grande(self, self->tam_tab - 1) == NULL);
   if (self->tam_tab == 0)
   {
     free(self->tabela);
@@ -91,53 +140,167 @@ static void tabpag__insere_pagina(tabpag_t *self, int pagina)
 void tabpag_define_quadro(tabpag_t *self, int pagina, int quadro)
 {
   assert(pagina >= 0);
+  tabpag__rebaixa(self, pagina);
   tabpag__insere_pagina(self, pagina);
   self->tabela[pagina].quadro = quadro;
   self->tabela[pagina].valida = true;
   self->tabela[pagina].acessada = false;
   self->tabela[pagina].alterada = false;
+  self->tabela[pagina].somente_leitura = false;
+  self->tabela[pagina].n_acessos = 0;
 }
 
 void tabpag_marca_bit_acesso(tabpag_t *self, int pagina, bool alteracao)
 {
-  if (!tabpag__pagina_valida(self, pagina))
+  descritor_t *d = tabpag__descritor(self, pagina);
+  if (d == NULL)
     return;
-  self->tabela[pagina].acessada = true;
+  d->acessada = true;
+  d->n_acessos++;
   if (alteracao)
   {
-    self->tabela[pagina].alterada = true;
+    d->alterada = true;
   }
 }
 
 void tabpag_zera_bit_acesso(tabpag_t *self, int pagina)
 {
-  if (!tabpag__pagina_valida(self, pagina))
+  descritor_t *d = tabpag__descritor(self, pagina);
+  if (d == NULL)
     return;
-  self->tabela[pagina].acessada = false;
+  d->acessada = false;
 }
 
 bool tabpag_bit_acesso(tabpag_t *self, int pagina)
 {
-  if (!tabpag__pagina_valida(self, pagina))
+  descritor_t *d = tabpag__descritor(self, pagina);
+  if (d == NULL)
     return false;
-  return self->tabela[pagina].acessada;
+  return d->acessada;
 }
 
 bool tabpag_bit_alteracao(tabpag_t *self, int pagina)
 {
-  if (!tabpag__pagina_valida(self, pagina))
+  descritor_t *d = tabpag__descritor(self, pagina);
+  if (d == NULL)
+    return false;
+  return d->alterada;
+}
+
+void tabpag_define_somente_leitura(tabpag_t *self, int pagina, bool somente_leitura)
+{
+  descritor_t *d = tabpag__descritor(self, pagina);
+  if (d == NULL || d->somente_leitura == somente_leitura)
+    return;
+  tabpag__rebaixa(self, pagina);
+  self->tabela[pagina].somente_leitura = somente_leitura;
+}
+
+bool tabpag_somente_leitura(tabpag_t *self, int pagina)
+{
+  descritor_t *d = tabpag__descritor(self, pagina);
+  if (d == NULL)
     return false;
-  return self->tabela[pagina].alterada;
+  return d->somente_leitura;
+}
+
+int tabpag_n_acessos(tabpag_t *self, int pagina)
+{
+  descritor_t *d = tabpag__descritor(self, pagina);
+  if (d == NULL)
+    return 0;
+  return d->n_acessos;
 }
 
 err_t tabpag_traduz(tabpag_t *self, int pagina, int *pquadro)
 {
+  descritor_t *g = tabpag__grande(self, pagina);
+  if (g != NULL)
+  {
+    *pquadro = g->quadro + pagina % self->tam_grande;
+    return ERR_OK;
+  }
   if (!tabpag__pagina_valida(self, pagina))
     return ERR_PAG_AUSENTE;
   *pquadro = self->tabela[pagina].quadro;
   return ERR_OK;
 }
 
+bool tabpag_promove(tabpag_t *self, int pagina)
+{
+  if (self->tam_grande == 0 || pagina < 0 || tabpag__grande(self, pagina) != NULL)
+    return false;
+  int primeira = pagina - pagina % self->tam_grande;
+  if (!tabpag__pagina_valida(self, primeira))
+    return false;
+  descritor_t grande = self->tabela[primeira];
+  if (grande.quadro % self->tam_grande != 0)
+    return false;
+  for (int i = 1; i < self->tam_grande; i++)
+  {
+    descritor_t *d = &self->tabela[primeira + i];
+    if (!tabpag__pagina_valida(self, primeira + i) || d->quadro != grande.quadro + i)
+      return false;
+    grande.acessada = grande.acessada || d->acessada;
+    grande.alterada = grande.alterada || d->alterada;
+    grande.n_acessos += d->n_acessos;
+  }
+  for (int i = 1; i < self->tam_grande; i++)
+  {
+    if (self->tabela[primeira + i].somente_leitura != grande.somente_leitura)
+      return false;
+  }
+  int g = primeira / self->tam_grande;
+  if (g >= self->n_grandes)
+  {
+    self->grandes = realloc(self->grandes, (g + 1) * sizeof(descritor_t));
+    assert(self->grandes != NULL);
+    while (self->n_grandes <= g)
+    {
+      self->grandes[self->n_grandes].valida = false;
+      self->n_grandes++;
+    }
+  }
+  self->grandes[g] = grande;
+  for (int i = 0; i < self->tam_grande; i++)
+  {
+    self->tabela[primeira + i].valida = false;
+  }
+  return true;
+}
+
+int tabpag_n_rebaixamentos(tabpag_t *self)
+{
+  return self->n_rebaixamentos;
+}
+
+bool tabpag_em_grande(tabpag_t *self, int pagina)
+{
+  return tabpag__grande(self, pagina) != NULL;
+}
+
+int tabpag_n_entradas(tabpag_t *self)
+{
+  int n = tabpag_n_grandes(self);
+  for (int pagina = 0; pagina < self->tam_tab; pagina++)
+  {
+    if (self->tabela[pagina].valida)
+      n++;
+  }
+  return n;
+}
+
+int tabpag_n_grandes(tabpag_t *self)
+{
+  int n = 0;
+  for (int g = 0; g < self->n_grandes; g++)
+  {
+    if (self->grandes[g].valida)
+      n++;
+  }
+  return n;
+}
+
 // minha func
 void print_tabela_paginas(tabpag_t *tabpag)
 {
@@ -146,4 +309,10 @@ void print_tabela_paginas(tabpag_t *tabpag)
   {
     console_printf("  index: %d quadro: %d, valida: %d", i, tabpag->tabela[i].quadro, tabpag->tabela[i].valida);
   }
+  for (int g = 0; g < tabpag->n_grandes; g++)
+  {
+    if (tabpag->grandes[g].valida)
+      console_printf("  grande: páginas %d a %d, quadros a partir de %d", g * tabpag->tam_grande,
+                     (g + 1) * tabpag->tam_grande - 1, tabpag->grandes[g].quadro);
+  }
 }
\ No newline at end of file
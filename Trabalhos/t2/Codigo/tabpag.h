@@ -10,7 +10,17 @@
 // realiza a tradução de números de páginas do espaço de endereçamento
 //   de um processo em números de quadros da memória principal onde essas
 //   páginas estão mapeadas
-// mantém para cada página mapeada um bit de acesso e um bit de alteração
+// mantém para cada página mapeada um bit de acesso e um bit de alteração, e
+//   se a página pode ser alterada
+// páginas consecutivas em quadros consecutivos podem ser promovidas a uma
+//   página grande, com um só descritor (e um só bit de acesso e de
+//   alteração) para todas elas; a página grande tem 'tam_grande' páginas, a
+//   primeira delas múltipla de 'tam_grande', em quadros a partir de um
+//   múltiplo de 'tam_grande', todas com a mesma proteção
+// as operações por página funcionam também com as páginas dentro de uma
+//   página grande; as que mudam o mapeamento de uma delas (definir o
+//   quadro, invalidar ou mudar a proteção) desfazem a página grande antes,
+//   e cada página volta a ter seu descritor, com os bits da grande
 
 #include "err.h"
 #include <stdbool.h>
@@ -27,6 +37,10 @@ typedef struct
     bool acessada;
     // a página foi alterada ou não
     bool alterada;
+    // a página está mapeada somente para leitura
+    bool somente_leitura;
+    // número de acessos à página desde que foi mapeada
+    int n_acessos;
 } descritor_t;
 
 typedef struct
@@ -34,16 +48,27 @@ typedef struct
     // número de descritores na tabela (pode ser 0)
     int tam_tab;
     // vetor com os descritores
-    // o último descritor do vetor sempre contém uma página válida
+    // o último descritor do vetor sempre contém uma página válida (ou que
+    //   está em uma página grande)
     // pode ser NULL (se tam_tab == 0)
     descritor_t *tabela;
+    // número de páginas de uma página grande (0 se não são usadas)
+    int tam_grande;
+    // descritores das páginas grandes: o descritor i, se for válido, mapeia
+    //   as páginas a partir de i * tam_grande nos quadros a partir do seu;
+    //   essas páginas não têm descritor válido em 'tabela'
+    int n_grandes;
+    descritor_t *grandes;
+    // número de páginas grandes desfeitas
+    int n_rebaixamentos;
 } tabpag_t;
 
-// cria uma tabela de páginas
+// cria uma tabela de páginas, com páginas grandes de 'tam_grande' páginas
+//   (0 para não usar páginas grandes)
 // retorna um ponteiro para um descritor, que deverá ser usado em todas
 //   as operações nessa tabela
 // mata o programa em caso de erro (malloc)
-tabpag_t *tabpag_cria(void);
+tabpag_t *tabpag_cria(int tam_grande);
 
 // destrói uma tabela de páginas
 // libera a memória ocupara pela tabela
@@ -52,7 +77,7 @@ void tabpag_destroi(tabpag_t *self);
 
 // define que a tradução da página 'pagina' deve resultar no quadro 'quadro'
 // essa página é marcada como válida, e os bits de acesso e alteração para essa
-//   página são zerados
+//   página são zerados; a página pode ser lida e alterada
 // páginas sem quadro definido são consideradas inválidas
 void tabpag_define_quadro(tabpag_t *self, int pagina, int quadro);
 
@@ -77,11 +102,43 @@ bool tabpag_bit_acesso(tabpag_t *self, int pagina);
 // retorna false se a página for inválida
 bool tabpag_bit_alteracao(tabpag_t *self, int pagina);
 
+// define se a página pode ser alterada; a MMU recusa escritas em páginas
+//   somente para leitura (ERR_PAG_PROTEGIDA)
+// não faz nada se a página for inválida
+void tabpag_define_somente_leitura(tabpag_t *self, int pagina, bool somente_leitura);
+
+// retorna true se a página está mapeada somente para leitura
+// retorna false se a página for inválida
+bool tabpag_somente_leitura(tabpag_t *self, int pagina);
+
+// retorna o número de acessos à página desde que ela foi mapeada
+// retorna 0 se a página for inválida
+int tabpag_n_acessos(tabpag_t *self, int pagina);
+
 // traduz a página 'pagina'; coloca o quadro correspondente na posição apontada
 //   por 'pquadro'
 // retorna ERR_PAG_AUSENTE (e não altera '*pquadro') se a página for inválida
 err_t tabpag_traduz(tabpag_t *self, int pagina, int *pquadro);
 
+// promove a uma página grande as páginas da página grande que contém
+//   'pagina'; todas devem estar mapeadas, com a mesma proteção, em quadros
+//   consecutivos a partir de um quadro alinhado
+// os bits de acesso e de alteração da página grande ficam ligados se
+//   estavam em alguma das páginas
+// retorna false se as páginas não podem ser promovidas
+bool tabpag_promove(tabpag_t *self, int pagina);
+
+// retorna true se a página faz parte de uma página grande
+bool tabpag_em_grande(tabpag_t *self, int pagina);
+
+// número de descritores de páginas válidos (contando uma vez cada página
+//   grande), e de páginas grandes
+int tabpag_n_entradas(tabpag_t *self);
+int tabpag_n_grandes(tabpag_t *self);
+
+// número de páginas grandes desfeitas
+int tabpag_n_rebaixamentos(tabpag_t *self);
+
 // imprime tabela
 void print_tabela_paginas(tabpag_t *tabpag);
 
@@ -6,19 +6,27 @@
 #include "terminal.h"
 
 #include <stdlib.h>
-#include <string.h>
 #include <assert.h>
 
 // TERMINAL
 
+// fila circular de caracteres
+typedef struct {
+  char *car;
+  // capacidade, posição do primeiro caractere e número de caracteres
+  int cap;
+  int inicio;
+  int n;
+} fila_car_t;
+
 // dados para cada terminal
 struct terminal_t {
   // número de caracteres que cabem em uma linha
   int tam_linha;
   // texto já digitado no terminal, esperando para ser lido
-  char *entrada;
+  fila_car_t entrada;
   // texto sendo mostrado na saída do terminal
-  char *saida;
+  fila_car_t saida;
   // normal: aceitando novos caracteres na saída
   // rolando: removendo um caractere no início para gerar espaço.
   //   move um caractere por vez para a esquerda, até chegar no final
@@ -30,58 +38,140 @@ struct terminal_t {
   //   entra nesse estado quando recebe um '\n'.
   //   não aceita novos caracteres
   enum { normal, rolando, limpando } estado_saida;
-  // posicao do caractere que está sendo movido durante uma rolagem
+  // número de caracteres já movidos durante uma rolagem
   int pos_rolagem;
+  // modo rápido: a rolagem e a limpeza são feitas na hora, sem passar pelos
+  //   estados rolando e limpando
+  bool rapido;
+  // cópias das filas como strings, para a console
+  char *txt_entrada;
+  char *txt_saida;
+  // arquivo de onde vem a entrada, relógio e intervalo entre os caracteres,
+  //   e instante em que o próximo caractere pode entrar
+  FILE *arq_entrada;
+  relogio_t *relogio;
+  int intervalo;
+  int proxima_entrada;
+  // arquivo que recebe uma cópia da saída
+  FILE *arq_saida;
 };
 
+static void fila_cria(fila_car_t *fila, int cap)
+{
+  fila->car = malloc(cap);
+  assert(fila->car != NULL);
+  fila->cap = cap;
+  fila->inicio = 0;
+  fila->n = 0;
+}
+
+static void fila_poe(fila_car_t *fila, char ch)
+{
+  fila->car[(fila->inicio + fila->n) % fila->cap] = ch;
+  fila->n++;
+}
+
+static char fila_tira(fila_car_t *fila)
+{
+  char ch = fila->car[fila->inicio];
+  fila->inicio = (fila->inicio + 1) % fila->cap;
+  fila->n--;
+  return ch;
+}
+
+// caractere na posição 'pos' a partir do início da fila
+static char fila_car(fila_car_t *fila, int pos)
+{
+  return fila->car[(fila->inicio + pos) % fila->cap];
+}
+
 
 terminal_t *terminal_cria(int tam_linha)
 {
   terminal_t *self = malloc(sizeof(*self));
   assert(self != NULL);
 
-  self->saida = malloc(tam_linha + 1);
-  self->entrada = malloc(tam_linha + 1);
-  assert(self->saida != NULL && self->entrada != NULL);
+  // cabem tam_linha-2 caracteres digitados e tam_linha-1 na saída
+  fila_cria(&self->entrada, tam_linha - 2);
+  fila_cria(&self->saida, tam_linha - 1);
+  self->txt_entrada = malloc(tam_linha + 1);
+  self->txt_saida = malloc(tam_linha + 1);
+  assert(self->txt_entrada != NULL && self->txt_saida != NULL);
 
   self->tam_linha = tam_linha;
-  strcpy(self->entrada, "");
-  strcpy(self->saida, "");
   self->estado_saida = normal;
+  self->rapido = false;
+  self->arq_entrada = NULL;
+  self->arq_saida = NULL;
 
   return self;
 }
 
 void terminal_destroi(terminal_t *self)
 {
-  free(self->entrada);
-  free(self->saida);
+  free(self->entrada.car);
+  free(self->saida.car);
+  free(self->txt_entrada);
+  free(self->txt_saida);
   free(self);
 }
 
+void terminal_define_rapido(terminal_t *self, bool rapido)
+{
+  self->rapido = rapido;
+}
+
+void terminal_define_entrada(terminal_t *self, FILE *arq, relogio_t *relogio, int intervalo)
+{
+  self->arq_entrada = arq;
+  self->relogio = relogio;
+  self->intervalo = intervalo;
+  self->proxima_entrada = intervalo > 0 ? relogio_agora(relogio) + intervalo : 0;
+}
+
+void terminal_define_saida(terminal_t *self, FILE *arq)
+{
+  self->arq_saida = arq;
+}
+
 static bool terminal_entrada_vazia(terminal_t *self)
 {
-  return self->entrada[0] == '\0';
+  return self->entrada.n == 0;
 }
 
 static char terminal_le_char(terminal_t *self)
 {
-  char *p = self->entrada;
-  char ch = p[0];
-  if (ch != '\0') {
-    memmove(&p[0], &p[1], strlen(p));
-  }
-  return ch;
+  if (terminal_entrada_vazia(self)) return '\0';
+  return fila_tira(&self->entrada);
 }
 
 void terminal_insere_char(terminal_t *self, char ch)
 {
-  char *p = self->entrada;
-  int tam = strlen(p);
   // se não cabe, ignora silenciosamente
-  if (tam >= self->tam_linha-2) return;
-  p[tam] = ch;
-  p[tam+1] = '\0';
+  if (self->entrada.n >= self->entrada.cap) return;
+  fila_poe(&self->entrada, ch);
+}
+
+// coloca na entrada os caracteres do arquivo de entrada que já podem entrar
+static void terminal_le_arquivo(terminal_t *self)
+{
+  while (self->arq_entrada != NULL && self->entrada.n < self->entrada.cap) {
+    int agora = 0;
+    if (self->intervalo > 0) {
+      agora = relogio_agora(self->relogio);
+      if (agora < self->proxima_entrada) return;
+    }
+    int ch = fgetc(self->arq_entrada);
+    if (ch == EOF) {
+      self->arq_entrada = NULL;
+      return;
+    }
+    fila_poe(&self->entrada, ch);
+    if (self->intervalo > 0) {
+      self->proxima_entrada = agora + self->intervalo;
+      return;
+    }
+  }
 }
 
 static bool terminal_pode_imprimir(terminal_t *self)
@@ -92,55 +182,64 @@ static bool terminal_pode_imprimir(terminal_t *self)
 static void terminal_imprime(terminal_t *self, char ch)
 {
   if (terminal_pode_imprimir(self)) {
+    if (self->arq_saida != NULL) {
+      fputc(ch, self->arq_saida);
+    }
     if (ch == '\n') {
-      self->estado_saida = limpando;
+      if (self->rapido) {
+        self->saida.n = 0;
+      } else {
+        self->estado_saida = limpando;
+      }
       return;
     }
-    int tam = strlen(self->saida);
-    self->saida[tam] = ch;
-    tam++;
-    self->saida[tam] = '\0';
-    if (tam >= self->tam_linha - 1) {
-      self->estado_saida = rolando;
-      self->pos_rolagem = 0;
+    fila_poe(&self->saida, ch);
+    if (self->saida.n >= self->saida.cap) {
+      if (self->rapido) {
+        fila_tira(&self->saida);
+      } else {
+        self->estado_saida = rolando;
+        self->pos_rolagem = 0;
+      }
     }
   }
 }
 
 void terminal_limpa_saida(terminal_t *self)
 {
-  self->saida[0] = '\0';
+  self->saida.n = 0;
   self->estado_saida = normal;
 }
 
 static void terminal_atualiza_rolagem(terminal_t *self)
 {
-  // remove o caractere na posição de rolagem e avança
-  // se chegou no final da string, terminou a rolagem
-  char *p = self->saida;
-  p[self->pos_rolagem] = p[self->pos_rolagem + 1];
-  if (p[self->pos_rolagem] != '\0') {
+  // move mais um caractere; se chegou no final da linha, terminou a
+  //   rolagem, e o primeiro caractere sai da fila
+  if (self->pos_rolagem + 1 < self->saida.n) {
     self->pos_rolagem++;
-    p[self->pos_rolagem] = ' ';
   } else {
+    fila_tira(&self->saida);
     self->estado_saida = normal;
   }
 }
 
 static void terminal_atualiza_limpeza(terminal_t *self)
 {
-  // remove um caractere do início da string; volta ao estado normal se era o último
-  char *p = self->saida;
-  int tam = strlen(p);
-  memmove(p, p+1, tam);
+  // remove um caractere do início; volta ao estado normal se era o último
+  int tam = self->saida.n;
+  if (tam > 0) {
+    fila_tira(&self->saida);
+  }
   if (tam <= 1) {
     self->estado_saida = normal;
   }
 }
 
-// altera a string de saída em 1 caractere, se estiver rolando ou limpando
+// altera a saída em 1 caractere, se estiver rolando ou limpando, e lê o
+//   arquivo de entrada
 void terminal_tictac(terminal_t *self)
 {
+  terminal_le_arquivo(self);
   switch (self->estado_saida) {
     case normal: 
       break;
@@ -155,12 +254,34 @@ void terminal_tictac(terminal_t *self)
 
 char *terminal_txt_entrada(terminal_t *self)
 {
-  return self->entrada;
+  fila_car_t *fila = &self->entrada;
+  for (int i = 0; i < fila->n; i++) {
+    self->txt_entrada[i] = fila_car(fila, i);
+  }
+  self->txt_entrada[fila->n] = '\0';
+  return self->txt_entrada;
 }
 
 char *terminal_txt_saida(terminal_t *self)
 {
-  return self->saida;
+  // durante a rolagem, os caracteres já movidos aparecem uma posição à
+  //   esquerda, seguidos de um espaço no lugar do próximo a mover
+  fila_car_t *fila = &self->saida;
+  char *p = self->txt_saida;
+  int movidos = 0;
+  if (self->estado_saida == rolando && self->pos_rolagem > 0) {
+    movidos = self->pos_rolagem;
+    for (int i = 0; i < movidos; i++) {
+      *p++ = fila_car(fila, i + 1);
+    }
+    *p++ = ' ';
+    movidos++;
+  }
+  for (int i = movidos; i < fila->n; i++) {
+    *p++ = fila_car(fila, i);
+  }
+  *p = '\0';
+  return self->txt_saida;
 }
 
 // Operações de leitura e escrita no terminal, chamadas pelo controlador de E/S
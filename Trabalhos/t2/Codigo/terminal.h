@@ -24,7 +24,16 @@
 //   adicional causa a "rolagem", que remove o primeiro caractere da linha para
 //   gerar espaço para o novo. a impressão de um \n causa a "limpeza" da linha.
 // a escrita não é possível se a saída estiver rolando ou sendo limpa, o que é
-//   feito um caractere por vez (a cada chamada a tictac).
+//   feito um caractere por vez (a cada chamada a tictac). no modo rápido, a
+//   rolagem e a limpeza são feitas na hora, e a saída está sempre pronta.
+// a entrada e a saída são mantidas em filas circulares, e cada caractere
+//   lido, inserido ou escrito custa tempo constante.
+//
+// a entrada pode também vir de um arquivo (ou pipe): seus caracteres entram na
+//   linha de entrada como se fossem digitados, quando houver espaço, ou um a
+//   cada tantas instruções, contadas pelo relógio; a leitura de um pipe sem
+//   dados espera que o escritor envie mais. os caracteres escritos na saída
+//   podem também ser copiados para um arquivo.
 //
 // a E/S efetiva é realizada pela console. ela obtém acesso às linhas de entrada e
 //   saída chamando terminal_txt_entrada ou terminal_txt_saida. a console insere
@@ -32,7 +41,9 @@
 //   linha de saída com terminal_limpa_saida.
 
 #include <stdbool.h>
+#include <stdio.h>
 #include "es.h"
+#include "relogio.h"
 
 typedef struct terminal_t terminal_t;
 
@@ -41,6 +52,23 @@ terminal_t *terminal_cria(int tam_linha);
 // libera a memória ocupada por um terminal
 void terminal_destroi(terminal_t *self);
 
+// liga ou desliga o modo rápido (desligado na criação); para quando
+//   ninguém está vendo a rolagem, e a velocidade da saída não deve limitar
+//   a dos programas
+void terminal_define_rapido(terminal_t *self, bool rapido);
+
+// faz a entrada vir também do arquivo 'arq' (NULL para só da console), até o
+//   fim dele: se 'intervalo' for 0, os caracteres entram sempre que houver
+//   espaço na linha de entrada; senão, entra um caractere a cada 'intervalo'
+//   instruções de 'relogio'
+// o arquivo não é fechado pelo terminal
+void terminal_define_entrada(terminal_t *self, FILE *arq, relogio_t *relogio, int intervalo);
+
+// copia para o arquivo 'arq' (NULL para não copiar) cada caractere escrito
+//   na saída, inclusive os '\n'
+// o arquivo não é fechado pelo terminal
+void terminal_define_saida(terminal_t *self, FILE *arq);
+
 // retorna a linha de entrada do terminal (para uso pela console)
 char *terminal_txt_entrada(terminal_t *self);
 
@@ -0,0 +1,243 @@
+// zswap.c
+// reserva de páginas comprimidas na memória principal
+// simulador de computador
+// so24b
+
+#include "zswap.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+// maior número de bytes de um valor codificado (32 bits, 7 por byte)
+#define MAX_BYTES_VALOR 5
+
+typedef struct
+{
+  // página comprimida (NULL se o bloco não tem página na reserva)
+  unsigned char *dados;
+  int tamanho;
+} entrada_t;
+
+struct zswap_t
+{
+  int n_blocos;
+  entrada_t *entradas;
+  int capacidade;
+  int usados;
+  // estatísticas
+  int pico_uso;
+  int n_guardadas;
+  int n_recusadas;
+  int n_recuperadas;
+  int bytes_originais;
+  int bytes_comprimidos;
+};
+
+zswap_t *zswap_cria(int n_blocos, int capacidade)
+{
+  zswap_t *self = malloc(sizeof(*self));
+  assert(self != NULL);
+  self->n_blocos = n_blocos;
+  self->entradas = calloc(n_blocos, sizeof(*self->entradas));
+  assert(self->entradas != NULL);
+  self->capacidade = capacidade;
+  self->usados = 0;
+  self->pico_uso = 0;
+  self->n_guardadas = 0;
+  self->n_recusadas = 0;
+  self->n_recuperadas = 0;
+  self->bytes_originais = 0;
+  self->bytes_comprimidos = 0;
+  return self;
+}
+
+void zswap_destroi(zswap_t *self)
+{
+  if (self == NULL)
+    return;
+  for (int bloco = 0; bloco < self->n_blocos; bloco++)
+  {
+    free(self->entradas[bloco].dados);
+  }
+  free(self->entradas);
+  free(self);
+}
+
+// CODIFICAÇÃO
+
+static int zswap__escreve_var(unsigned char *saida, uint32_t v)
+{
+  int n = 0;
+  while (v >= 0x80)
+  {
+    saida[n++] = (v & 0x7f) | 0x80;
+    v >>= 7;
+  }
+  saida[n++] = v;
+  return n;
+}
+
+static int zswap__le_var(unsigned char *entrada, uint32_t *v)
+{
+  int n = 0;
+  int desloc = 0;
+  *v = 0;
+  do
+  {
+    *v |= (uint32_t)(entrada[n] & 0x7f) << desloc;
+    desloc += 7;
+  } while (entrada[n++] & 0x80);
+  return n;
+}
+
+// comprime os valores em 'saida', que deve ter espaço para
+//   n * MAX_BYTES_VALOR bytes; retorna o número de bytes usados
+static int zswap__comprime(int n, int valores[n], unsigned char *saida)
+{
+  int tam = 0;
+  uint32_t anterior = 0;
+  for (int i = 0; i < n; i++)
+  {
+    // a diferença em zigue-zague: 0, -1, 1, -2, 2... viram 0, 1, 2, 3, 4...
+    int32_t dif = (int32_t)((uint32_t)valores[i] - anterior);
+    uint32_t z = ((uint32_t)dif << 1) ^ (uint32_t)(dif >> 31);
+    anterior = valores[i];
+    tam += zswap__escreve_var(saida + tam, z);
+    if (z == 0)
+    {
+      // diferença 0: seguida do número de valores iguais que vêm depois
+      int repeticoes = 0;
+      while (i + 1 < n && (uint32_t)valores[i + 1] == anterior)
+      {
+        repeticoes++;
+        i++;
+      }
+      tam += zswap__escreve_var(saida + tam, repeticoes);
+    }
+  }
+  return tam;
+}
+
+static void zswap__descomprime(unsigned char *entrada, int n, int valores[n])
+{
+  uint32_t anterior = 0;
+  int i = 0;
+  while (i < n)
+  {
+    uint32_t z;
+    entrada += zswap__le_var(entrada, &z);
+    uint32_t dif = (z >> 1) ^ -(z & 1);
+    anterior += dif;
+    valores[i++] = anterior;
+    if (z == 0)
+    {
+      uint32_t repeticoes;
+      entrada += zswap__le_var(entrada, &repeticoes);
+      while (repeticoes-- > 0 && i < n)
+        valores[i++] = anterior;
+    }
+  }
+}
+
+// OPERAÇÕES
+
+static bool zswap__bloco_valido(zswap_t *self, int bloco)
+{
+  return bloco >= 0 && bloco < self->n_blocos;
+}
+
+void zswap_remove(zswap_t *self, int bloco)
+{
+  if (!zswap__bloco_valido(self, bloco) || self->entradas[bloco].dados == NULL)
+    return;
+  entrada_t *e = &self->entradas[bloco];
+  self->usados -= e->tamanho;
+  free(e->dados);
+  e->dados = NULL;
+  e->tamanho = 0;
+}
+
+bool zswap_guarda(zswap_t *self, int bloco, int n, int valores[n])
+{
+  if (!zswap__bloco_valido(self, bloco))
+    return false;
+  zswap_remove(self, bloco);
+  unsigned char comprimida[n * MAX_BYTES_VALOR];
+  int tam = zswap__comprime(n, valores, comprimida);
+  int tam_original = n * (int)sizeof(int);
+  if (tam >= tam_original || self->usados + tam > self->capacidade)
+  {
+    self->n_recusadas++;
+    return false;
+  }
+  entrada_t *e = &self->entradas[bloco];
+  e->dados = malloc(tam);
+  assert(e->dados != NULL);
+  memcpy(e->dados, comprimida, tam);
+  e->tamanho = tam;
+  self->usados += tam;
+  if (self->usados > self->pico_uso)
+    self->pico_uso = self->usados;
+  self->n_guardadas++;
+  self->bytes_originais += tam_original;
+  self->bytes_comprimidos += tam;
+  return true;
+}
+
+bool zswap_contem(zswap_t *self, int bloco)
+{
+  return zswap__bloco_valido(self, bloco) && self->entradas[bloco].dados != NULL;
+}
+
+bool zswap_recupera(zswap_t *self, int bloco, int n, int valores[n])
+{
+  if (!zswap_contem(self, bloco))
+    return false;
+  zswap__descomprime(self->entradas[bloco].dados, n, valores);
+  self->n_recuperadas++;
+  return true;
+}
+
+// ESTATÍSTICAS
+
+int zswap_capacidade(zswap_t *self)
+{
+  return self->capacidade;
+}
+
+int zswap_bytes_usados(zswap_t *self)
+{
+  return self->usados;
+}
+
+int zswap_pico_uso(zswap_t *self)
+{
+  return self->pico_uso;
+}
+
+int zswap_n_guardadas(zswap_t *self)
+{
+  return self->n_guardadas;
+}
+
+int zswap_n_recusadas(zswap_t *self)
+{
+  return self->n_recusadas;
+}
+
+int zswap_n_recuperadas(zswap_t *self)
+{
+  return self->n_recuperadas;
+}
+
+int zswap_bytes_originais(zswap_t *self)
+{
+  return self->bytes_originais;
+}
+
+int zswap_bytes_comprimidos(zswap_t *self)
+{
+  return self->bytes_comprimidos;
+}
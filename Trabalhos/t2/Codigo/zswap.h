@@ -0,0 +1,64 @@
+// zswap.h
+// reserva de páginas comprimidas na memória principal
+// simulador de computador
+// so24b
+
+#ifndef ZSWAP_H
+#define ZSWAP_H
+
+// guarda, comprimidas, páginas que iriam ser gravadas na memória secundária,
+//   identificadas pelo bloco do espaço de troca que é delas
+// enquanto uma página está na reserva, é ela que vale, e não o que está no
+//   bloco da memória secundária
+// a compressão codifica cada valor pela diferença para o anterior, com
+//   tamanho variável (7 bits por byte, números pequenos positivos ou
+//   negativos ocupam 1 byte); uma sequência de valores iguais ocupa 2 bytes
+// se a página não cabe no espaço livre da reserva, ou não fica menor
+//   comprimida, ela não é guardada
+
+#include <stdbool.h>
+
+// tipo opaco que representa a reserva
+typedef struct zswap_t zswap_t;
+
+// cria uma reserva vazia com 'capacidade' bytes, para páginas dos blocos 0
+//   a 'n_blocos' - 1
+// mata o programa em caso de erro (malloc)
+zswap_t *zswap_cria(int n_blocos, int capacidade);
+
+// destrói a reserva
+void zswap_destroi(zswap_t *self);
+
+// guarda a página com os 'n' valores em 'valores' como a página do bloco
+//   'bloco', no lugar da que estava guardada
+// retorna false se a página não foi guardada (a que estava guardada para o
+//   bloco é descartada do mesmo jeito)
+bool zswap_guarda(zswap_t *self, int bloco, int n, int valores[n]);
+
+// retorna true se a reserva tem a página do bloco 'bloco'
+bool zswap_contem(zswap_t *self, int bloco);
+
+// descomprime a página do bloco 'bloco' em 'valores'
+// retorna false se a reserva não tem a página
+bool zswap_recupera(zswap_t *self, int bloco, int n, int valores[n]);
+
+// descarta a página do bloco 'bloco', se houver
+void zswap_remove(zswap_t *self, int bloco);
+
+// ESTATÍSTICAS
+
+// capacidade, bytes em uso, e maior número de bytes em uso ao mesmo tempo
+int zswap_capacidade(zswap_t *self);
+int zswap_bytes_usados(zswap_t *self);
+int zswap_pico_uso(zswap_t *self);
+
+// número de páginas guardadas, recusadas e recuperadas
+int zswap_n_guardadas(zswap_t *self);
+int zswap_n_recusadas(zswap_t *self);
+int zswap_n_recuperadas(zswap_t *self);
+
+// soma dos tamanhos das páginas guardadas, sem e com compressão
+int zswap_bytes_originais(zswap_t *self);
+int zswap_bytes_comprimidos(zswap_t *self);
+
+#endif // ZSWAP_H